@@ -0,0 +1,78 @@
+/**
+ * Just enough of the Arduino core to build the library on a PC.
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include "Arduino.h"
+
+static int pins[HOST_PINS];
+static HostAnalogSource analogSource = nullptr;
+
+static uint64_t hostMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t millis() {
+    return hostMicros() / 1000;
+}
+
+uint32_t micros() {
+    return hostMicros();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+int analogRead(uint8_t pin) {
+    if (analogSource) {
+        return analogSource(pin);
+    }
+    return pin < HOST_PINS ? pins[pin] : 0;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PINS ? pins[pin] : LOW;
+}
+
+void analogWrite(uint8_t, int) {}
+
+void digitalWrite(uint8_t, uint8_t) {}
+
+void hostSetAnalog(uint8_t pin, int value) {
+    if (pin < HOST_PINS) pins[pin] = value;
+}
+
+void hostSetDigital(uint8_t pin, int value) {
+    if (pin < HOST_PINS) pins[pin] = value;
+}
+
+void hostSetAnalogSource(HostAnalogSource source) {
+    analogSource = source;
+}
+
+size_t Print::print(long n) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%ld", n);
+    return print(buffer);
+}
+
+size_t Print::print(unsigned long n) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%lu", n);
+    return print(buffer);
+}
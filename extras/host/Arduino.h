@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+ * Just enough of the Arduino core to build the library on a PC, for the
+ * host tools in this folder. Not used when building for a board.
+ * 
+ * Pins read whatever was last set with hostSetAnalog()/hostSetDigital()
+ * (or come from hostSetAnalogSource()), and millis()/micros() are the real
+ * time since the program started.
+ * Controls take their time from Clock, so use Clock::setSource() to drive
+ * them from a simulated or recorded clock instead.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_float(p) (*(const float *)(p))
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define HOST_PINS 64
+
+#define bit(b) (1UL << (b))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+uint32_t millis();
+uint32_t micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int analogRead(uint8_t pin);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+/**
+ * Set what the next read of a pin returns.
+ */
+void hostSetAnalog(uint8_t pin, int value);
+void hostSetDigital(uint8_t pin, int value);
+
+/**
+ * Read analog pins from a function instead, ie a simulated signal that moves
+ * on with every read. nullptr goes back to hostSetAnalog().
+ */
+typedef int (*HostAnalogSource)(uint8_t pin);
+void hostSetAnalogSource(HostAnalogSource source);
+
+/**
+ * Minimal Print, with the overloads the library uses.
+ */
+class Print {
+
+  public:
+
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t b) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      size_t n = 0;
+      while (size--) {
+        n += write(*buffer++);
+      }
+      return n;
+    }
+
+    virtual int availableForWrite() { return 0; }
+
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n) { return print((long)n); }
+    size_t print(unsigned int n) { return print((unsigned long)n); }
+    size_t print(long n);
+    size_t print(unsigned long n);
+
+    template<class T> size_t println(T value) { return print(value) + println(); }
+    size_t println() { return print("\n"); }
+
+};
@@ -0,0 +1,77 @@
+/**
+ * Checks that controls read outside ControlScheduler still see time moving
+ * after poll(), ie that poll() releases the Clock at the end of its scan.
+ *
+ * A Button read directly from the sketch must still debounce: a bounce
+ * inside the debounce time is ignored, and a press held past it is seen.
+ *
+ * Usage: clock_test (exits non-zero on failure)
+ */
+
+#include <stdio.h>
+#include "Simple_Controls.h"
+
+static uint32_t simMillis = 0;
+
+static uint32_t simClockMillis() {
+    return simMillis;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+    failures += !ok;
+}
+
+int main() {
+
+    Clock::setSource(simClockMillis);
+
+    const byte BUTTON = 2;
+    hostSetAnalog(A0, 512);
+    hostSetDigital(BUTTON, HIGH);
+
+    Potentiometer pot(A0);
+    Button button(BUTTON, 25);
+    pot.begin();
+    button.begin();
+
+    ControlScheduler<1> scheduler;
+    scheduler.add(pot);
+
+    //the sketch polls the scheduler, then reads the button itself
+    simMillis = 100;
+    scheduler.poll();
+    check(!Clock::isTicking(), "poll() releases the clock");
+
+    simMillis = 110;
+    hostSetDigital(BUTTON, LOW);
+    button.read();
+    check(button.wasPressed(), "press seen");
+
+    //a bounce inside the debounce time is ignored
+    scheduler.poll();
+    simMillis = 115;
+    hostSetDigital(BUTTON, HIGH);
+    button.read();
+    check(button.isPressed() && !button.changed(), "bounce ignored");
+
+    //the button is really released, and stays released past the debounce time
+    scheduler.poll();
+    simMillis = 140;
+    button.read();
+    check(button.wasReleased(), "release seen after the debounce time");
+    check(button.lastChange() == 140, "release timed on live clock");
+
+    //a sketch that ticks itself keeps its own time through poll()
+    Clock::tick();
+    simMillis = 200;
+    scheduler.poll();
+    check(Clock::isTicking() && Clock::now() == 140, "sketch tick kept");
+    Clock::release();
+
+    printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+
+}
@@ -0,0 +1,75 @@
+/**
+ * Checks ButtonGesture click counting against the multi click window.
+ *
+ * Two clicks further apart than the window must be two single clicks, even
+ * when update() is not called during the gap (ie the button is on a decayed
+ * ControlScheduler slot), while two clicks inside the window are a double.
+ *
+ * Usage: gesture_test (exits non-zero on failure)
+ */
+
+#include <stdio.h>
+#include "Simple_Controls.h"
+
+static const byte PIN = 2;
+
+static uint32_t simMillis = 0;
+
+static uint32_t simClockMillis() {
+    return simMillis;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+    failures += !ok;
+}
+
+static Button button(PIN, 10);
+static ButtonGesture gesture;
+static GestureTiming timing;
+
+/**
+ * Move to a time, set the pin (LOW is pressed), read and update.
+ */
+static ButtonGesture::Event step(uint32_t ms, int level) {
+    simMillis = ms;
+    hostSetDigital(PIN, level);
+    button.read();
+    return gesture.update(button, timing);
+}
+
+int main() {
+
+    Clock::setSource(simClockMillis);
+    hostSetDigital(PIN, HIGH);
+    button.begin();
+
+    //a click, then a second click well after the window, with no update() in the gap
+    step(100, LOW);
+    step(150, HIGH);
+    ButtonGesture::Event event = step(100 + 150 + timing.multiClick + 200, LOW);
+    check(event == ButtonGesture::CLICK && gesture.clicks() == 1, "late press first ends the pending click");
+    step(800, HIGH);
+    event = step(800 + timing.multiClick, HIGH);
+    check(event == ButtonGesture::CLICK && gesture.clicks() == 1, "second click is a single click");
+
+    //two clicks inside the window
+    step(2000, LOW);
+    step(2050, HIGH);
+    step(2150, LOW);
+    step(2200, HIGH);
+    event = step(2200 + timing.multiClick, HIGH);
+    check(event == ButtonGesture::DOUBLE_CLICK && gesture.clicks() == 2, "clicks inside the window are a double click");
+
+    //a long press released without an update() at the deadline
+    step(3000, LOW);
+    event = step(3000 + timing.longPress + 50, HIGH);
+    check(event == ButtonGesture::LONG_PRESS, "long press seen before its release");
+    check(step(5000, HIGH) == ButtonGesture::NONE && !gesture.isArmed(), "idle after the long press");
+
+    printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+
+}
@@ -0,0 +1,120 @@
+/**
+ * Measures how much effective latency MotionEstimator prediction removes.
+ *
+ * Sweeps a simulated pot at a constant speed, with optional noise, through
+ * a Potentiometer with a TimeConstantFilter and a MotionEstimator, and
+ * compares how far the filtered and predicted values trail the true position
+ * during the steady part of the sweep. The lag in milliseconds is the mean
+ * tracking error divided by the speed. It also reports how much the
+ * predicted value wanders once the pot is resting again.
+ *
+ * Usage: motion_harness [options]
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include "Simple_Controls.h"
+
+static uint32_t simMicros = 0;
+
+static uint32_t simClockMillis() {
+    return simMicros / 1000;
+}
+
+static uint32_t simClockMicros() {
+    return simMicros;
+}
+
+static void usage() {
+    fprintf(stderr,
+        "Usage: motion_harness [options]\n"
+        "\n"
+        "  -t ms        smoothing time constant (default: 30)\n"
+        "  -a ms        how far ahead to predict (default: 30)\n"
+        "  -v speed     sweep speed in raw units per second (default: 5000)\n"
+        "  -p us        time between reads (default: 500)\n"
+        "  -n noise     +/- raw noise added to every read (default: 0)\n"
+        "  -m shift     MotionEstimator smoothing shift (default: 3)\n");
+}
+
+int main(int argc, char **argv) {
+
+    unsigned int timeConstant = 30, ahead = 30, period = 500, noise = 0, shift = 3;
+    long speed = 5000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:a:v:p:n:m:h")) != -1) {
+        switch (opt) {
+            case 't': timeConstant = atoi(optarg); break;
+            case 'a': ahead = atoi(optarg); break;
+            case 'v': speed = atol(optarg); break;
+            case 'p': period = atoi(optarg); break;
+            case 'n': noise = atoi(optarg); break;
+            case 'm': shift = atoi(optarg); break;
+            default: usage(); return 2;
+        }
+    }
+    if (speed <= 0 || period == 0) {
+        usage();
+        return 2;
+    }
+
+    Clock::setSource(simClockMillis, simClockMicros);
+    srand(1);
+
+    TimeConstantFilter filter(timeConstant);
+    MotionEstimator motion(shift);
+    Potentiometer pot(A0, 0, 0, 1, 0);
+    pot.setSmoothingFilter(&filter);
+    pot.setMotionEstimator(&motion);
+
+    const int from = 12, to = Potentiometer::MAX - 12;
+    const uint32_t rest = 100000;
+    const uint32_t sweep = (uint64_t)(to - from) * 1000000 / speed;
+
+    hostSetAnalog(A0, from);
+    pot.begin();
+
+    //skip the start of the sweep, while the filter and estimator catch up
+    uint32_t measureFrom = rest + min(sweep / 4, (uint32_t)(5 * timeConstant * 1000));
+    double filteredError = 0, predictedError = 0;
+    long samples = 0;
+    int restLow = Potentiometer::MAX, restHigh = 0;
+
+    for (simMicros = period; simMicros < 2 * rest + sweep + 5 * timeConstant * 1000 + rest; simMicros += period) {
+
+        long position = simMicros < rest ? from
+            : min((long)to, from + (long)((uint64_t)(simMicros - rest) * speed / 1000000));
+        int jitter = noise ? rand() % (2 * noise + 1) - noise : 0;
+        hostSetAnalog(A0, constrain(position + jitter, 0, Potentiometer::MAX));
+        pot.read();
+
+        if (simMicros >= measureFrom && simMicros < rest + sweep) {
+            filteredError += position - pot.getRawValue();
+            predictedError += position - pot.getPredictedValue(ahead);
+            samples++;
+        } else if (simMicros > rest + sweep + 5 * timeConstant * 1000 + rest / 2) {
+            int predicted = pot.getPredictedValue(ahead);
+            restLow = min(restLow, predicted);
+            restHigh = max(restHigh, predicted);
+        }
+
+    }
+
+    if (!samples) {
+        fprintf(stderr, "sweep too short to measure, lower the speed\n");
+        return 1;
+    }
+
+    filteredError /= samples;
+    predictedError /= samples;
+    printf("sweep:      %ld units/s, read every %u us, noise +/-%u\n", speed, period, noise);
+    printf("config:     time constant %u ms, predicting %u ms ahead, estimator shift %u\n", timeConstant, ahead, shift);
+    printf("filtered:   trails by %.1f units, %.1f ms\n", filteredError, filteredError * 1000 / speed);
+    printf("predicted:  trails by %.1f units, %.1f ms\n", predictedError, predictedError * 1000 / speed);
+    printf("removed:    %.1f ms of lag\n", (filteredError - predictedError) * 1000 / speed);
+    printf("at rest:    predicted value stays within %d-%d\n", restLow, restHigh);
+
+    return 0;
+
+}
@@ -0,0 +1,618 @@
+/**
+ * Replays a trace recorded with TraceRecorder through a control on a PC, and
+ * reports how a configuration behaves on real recorded input.
+ *
+ * For a Potentiometer (the default):
+ *
+ *   - spurious changes: changes reported while the input was resting, after
+ *     the output had already settled on it
+ *   - step-response latency: from the input arriving at a new resting value
+ *     to the output settling within the rest band of it, ie the lag the
+ *     filter adds on top of the movement itself
+ *   - CPU cost: host time spent in read(), to compare configurations
+ *
+ * For a Joystick (-m joystick), a sweep of thresholds, with for each one the
+ * changes, the spurious changes while both axes were resting, and how much of
+ * the time the stick was outside the dead zone.
+ *
+ * For a Button (-m button), the raw edges against the debounced edges, the
+ * edges the debounce filtered out, and the delay from the first raw edge to
+ * the debounced one.
+ *
+ * The control runs on the recorded timestamps (TracePlayer drives Clock), so
+ * time-constant smoothing and debouncing behave as they did on the board.
+ * Read delays are not replayed. Each recorded sample of a pot or button is one
+ * read(), and each sample of a joystick's y axis completes one read().
+ *
+ * Usage: sc_replay [options] trace.bin
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+#include "Simple_Controls.h"
+#include "SC_MultiplexingJoystick.h"
+
+#if !SC_ENABLE_TRACE
+#error "Build with -DSC_ENABLE_TRACE=1"
+#endif
+
+enum Mode { POT, JOYSTICK, BUTTON };
+
+struct Options {
+    Mode mode = POT;
+    int pin = -1;
+    int channel = TRACE_NO_CHANNEL;
+    int pinY = -1;
+    int channelY = TRACE_NO_CHANNEL;
+    int resolution = 0;
+    float smoothing = 0.6;
+    unsigned int smoothingTime = 0;
+    int noiseFloor = 0;
+    int band = 4;
+    uint32_t restMicros = 50000;
+    int thresholdFrom = 25, thresholdTo = 300, thresholdStep = 25;
+    boolean radial = false;
+    unsigned int debounce = 25;
+    boolean activeHigh = false;
+};
+
+struct Report {
+    unsigned long reads = 0;
+    unsigned long changes = 0;
+    unsigned long spurious = 0;
+    unsigned long steps = 0;
+    unsigned long unsettled = 0;
+    double latencyTotal = 0;
+    double latencyMax = 0;
+    double readNanos = 0;
+};
+
+struct JoystickReport {
+    int threshold = 0;
+    unsigned long reads = 0;
+    unsigned long changes = 0;
+    unsigned long spurious = 0;
+    double outside = 0;
+    double readNanos = 0;
+};
+
+struct ButtonReport {
+    unsigned long reads = 0;
+    unsigned long rawEdges = 0;
+    unsigned long presses = 0;
+    unsigned long releases = 0;
+    unsigned long filtered = 0;
+    double delayTotal = 0;
+    double delayMax = 0;
+    double readNanos = 0;
+};
+
+static void usage() {
+    fprintf(stderr,
+        "Usage: sc_replay [options] trace.bin\n"
+        "\n"
+        "  -m mode      pot, joystick or button (default: pot)\n"
+        "  -p pin       pin to replay, the x axis of a joystick (default: first pin in the trace)\n"
+        "  -c channel   mux channel (default: none)\n"
+        "  -y pin[:ch]  joystick y axis pin and mux channel (default: second pin in the trace)\n"
+        "  -b band      raw units the input may move and still be resting (default: 4)\n"
+        "  -w ms        how long the input must stay in the band to be resting (default: 50)\n"
+        "\n"
+        "pot:\n"
+        "  -r res       resolution (default: 0)\n"
+        "  -s factor    smoothing factor (default: 0.6)\n"
+        "  -t ms        smoothing time constant, replaces the factor (default: off)\n"
+        "  -n floor     noise floor (default: 0)\n"
+        "\n"
+        "joystick:\n"
+        "  -T a:b:step  thresholds to sweep (default: 25:300:25)\n"
+        "  -R           radial dead zone\n"
+        "\n"
+        "button:\n"
+        "  -d ms        debounce time (default: 25)\n"
+        "  -i           pressed reads high (default: pressed reads low)\n");
+}
+
+/**
+ * Read and decode a whole trace.
+ */
+static bool load(const char *path, std::vector<TraceSample> &samples) {
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    TraceDecoder decoder;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (decoder.push((byte)c)) {
+            samples.push_back(decoder.sample());
+        }
+        if (decoder.failed()) {
+            fprintf(stderr, "%s: not a trace, or corrupt after %zu samples\n", path, samples.size());
+            fclose(file);
+            return false;
+        }
+    }
+
+    fclose(file);
+    return true;
+
+}
+
+/**
+ * Just the samples of one pin.
+ */
+static std::vector<TraceSample> select(const std::vector<TraceSample> &samples, int pin, int channel) {
+    std::vector<TraceSample> input;
+    for (const TraceSample &s : samples) {
+        if (s.pin == pin && s.channel == channel) {
+            input.push_back(s);
+        }
+    }
+    return input;
+}
+
+/**
+ * Mark each sample as resting if the input stays within the band
+ * for the rest window centred on it.
+ */
+static std::vector<bool> findRest(const std::vector<TraceSample> &input, const Options &options) {
+
+    std::vector<bool> rest(input.size());
+    uint32_t half = options.restMicros / 2;
+    size_t first = 0, last = 0;
+
+    for (size_t i=0; i<input.size(); i++) {
+
+        uint32_t t = input[i].time;
+        while (input[i].time - input[first].time > half) first++;
+        while (last + 1 < input.size() && input[last + 1].time - t <= half) last++;
+
+        //only a full window can show the input resting
+        if (t - input[0].time < half || input.back().time - t < half) {
+            continue;
+        }
+
+        int lo = input[first].value, hi = lo;
+        for (size_t j=first; j<=last; j++) {
+            lo = min(lo, input[j].value);
+            hi = max(hi, input[j].value);
+        }
+        rest[i] = hi - lo <= options.band;
+
+    }
+
+    return rest;
+
+}
+
+/**
+ * A stretch of resting input.
+ */
+struct Segment {
+    size_t start, end;
+    int value;
+};
+
+static std::vector<Segment> findSegments(const std::vector<TraceSample> &input, const std::vector<bool> &rest) {
+
+    std::vector<Segment> segments;
+
+    for (size_t i=0; i<input.size(); i++) {
+        if (!rest[i]) {
+            continue;
+        }
+        size_t start = i;
+        long sum = 0;
+        while (i < input.size() && rest[i]) {
+            sum += input[i++].value;
+        }
+        segments.push_back({ start, i - 1, (int)(sum / (long)(i - start)) });
+    }
+
+    return segments;
+
+}
+
+/**
+ * Run the trace through a pot and measure it.
+ */
+static Report replay(const std::vector<TraceSample> &samples, const Options &options) {
+
+    Report report;
+
+    std::vector<TraceSample> input = select(samples, options.pin, options.channel);
+    if (input.empty()) {
+        return report;
+    }
+
+    Multiplexer mux(0, 0, 0, 0);
+    boolean muxed = options.channel != TRACE_NO_CHANNEL;
+    Potentiometer pot(options.pin, options.resolution, options.smoothing, 1, 0, muxed ? &mux : nullptr, options.channel);
+    pot.setNoiseFloor(options.noiseFloor);
+
+    TimeConstantFilter filter(options.smoothingTime);
+    if (options.smoothingTime) {
+        pot.setSmoothingFilter(&filter);
+    }
+
+    TracePlayer player;
+    player.start();
+    player.apply(input[0]);
+    pot.begin();
+
+    //replay, keeping the output of every read
+    std::vector<int> output(input.size());
+    std::vector<bool> changed(input.size());
+    output[0] = pot.getRawValue();
+    double nanos = 0;
+
+    for (size_t i=1; i<input.size(); i++) {
+        player.apply(input[i]);
+        auto begin = std::chrono::steady_clock::now();
+        changed[i] = pot.read();
+        nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        output[i] = pot.getRawValue();
+        report.reads++;
+        report.changes += changed[i];
+    }
+
+    player.stop();
+    report.readNanos = report.reads ? nanos / report.reads : 0;
+
+    std::vector<bool> rest = findRest(input, options);
+    std::vector<Segment> segments = findSegments(input, rest);
+
+    for (size_t s=0; s<segments.size(); s++) {
+
+        const Segment &segment = segments[s];
+        size_t from = s > 0 ? segments[s - 1].end + 1 : 0;
+
+        //the input arrives when it first gets within the band of the new rest
+        size_t arrived = from;
+        while (arrived < segment.end && abs(input[arrived].value - segment.value) > options.band) {
+            arrived++;
+        }
+
+        //the output settles when it does the same
+        size_t settled = arrived;
+        while (settled <= segment.end && abs(output[settled] - segment.value) > options.band) {
+            settled++;
+        }
+        if (settled > segment.end) {
+            report.unsettled++;
+            continue;
+        }
+
+        //latency the filter adds to a real step
+        if (s > 0 && abs(segment.value - segments[s - 1].value) > 2 * options.band) {
+            double latency = (input[settled].time - input[arrived].time) / 1000.0;
+            report.steps++;
+            report.latencyTotal += latency;
+            report.latencyMax = max(report.latencyMax, latency);
+        }
+
+        //once settled, any change while resting is noise getting through
+        for (size_t i=max(settled + 1, segment.start); i<=segment.end; i++) {
+            report.spurious += changed[i];
+        }
+
+    }
+
+    return report;
+
+}
+
+/**
+ * Run the trace through a joystick with one threshold and measure it.
+ */
+static JoystickReport replayJoystick(const std::vector<TraceSample> &samples, const Options &options, int threshold) {
+
+    JoystickReport report;
+    report.threshold = threshold;
+
+    Multiplexer mux(0, 0, 0, 0);
+    Joystick direct(options.pin, options.pinY, threshold);
+    MultiplexingJoystick muxed(options.pin, &mux, options.channel, options.channelY, threshold);
+    Joystick &joystick = options.channel != TRACE_NO_CHANNEL ? muxed : direct;
+    joystick.setRadialDeadZone(options.radial);
+
+    //one read per y sample, once both axes have a value
+    std::vector<TraceSample> xs, ys;
+    std::vector<bool> changed;
+    boolean haveX = false;
+    double nanos = 0;
+
+    TracePlayer player;
+    player.start();
+
+    for (const TraceSample &s : samples) {
+
+        boolean isX = s.pin == options.pin && s.channel == options.channel;
+        boolean isY = s.pin == options.pinY && s.channel == options.channelY;
+        if (!isX && !isY) {
+            continue;
+        }
+        player.apply(s);
+        if (isX) {
+            haveX = true;
+            continue;
+        }
+        if (!haveX) {
+            continue;
+        }
+
+        TraceSample x = s;
+        x.value = player.read(options.pin, options.channel);
+        xs.push_back(x);
+        ys.push_back(s);
+
+        if (xs.size() == 1) {
+            joystick.begin();
+            changed.push_back(false);
+            continue;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        joystick.read();
+        nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        changed.push_back(joystick.changed());
+        report.reads++;
+        report.changes += joystick.changed();
+        report.outside += joystick.getDirection() != Joystick::NO_DIRECTION;
+
+    }
+
+    player.stop();
+    if (!report.reads) {
+        return report;
+    }
+    report.readNanos = nanos / report.reads;
+    report.outside = 100 * report.outside / report.reads;
+
+    //any change while both axes are resting is noise crossing the threshold
+    std::vector<bool> restX = findRest(xs, options);
+    std::vector<bool> restY = findRest(ys, options);
+    for (size_t i=1; i<changed.size(); i++) {
+        report.spurious += changed[i] && restX[i] && restY[i];
+    }
+
+    return report;
+
+}
+
+/**
+ * Run the trace through a button and measure it.
+ */
+static ButtonReport replayButton(const std::vector<TraceSample> &samples, const Options &options) {
+
+    ButtonReport report;
+
+    std::vector<TraceSample> input = select(samples, options.pin, options.channel);
+    if (input.empty()) {
+        return report;
+    }
+
+    Multiplexer mux(0, 0, 0, 0);
+    boolean muxed = options.channel != TRACE_NO_CHANNEL;
+    Button button(options.pin, options.debounce, !options.activeHigh, !options.activeHigh, muxed ? &mux : nullptr, options.channel);
+
+    TracePlayer player;
+    player.start();
+    player.apply(input[0]);
+    button.begin();
+
+    //when the raw input first left the debounced state, and when it last disagreed with it
+    uint32_t firstEdge = 0, lastDiffer = 0;
+    boolean pending = false;
+    double nanos = 0;
+
+    for (size_t i=1; i<input.size(); i++) {
+
+        player.apply(input[i]);
+        report.rawEdges += input[i].value != input[i - 1].value;
+
+        auto begin = std::chrono::steady_clock::now();
+        button.read();
+        nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        report.reads++;
+
+        uint32_t t = input[i].time;
+        boolean pressed = (input[i].value != LOW) == options.activeHigh;
+
+        if (button.changed()) {
+            report.presses += button.isPressed();
+            report.releases += button.isReleased();
+            double delay = pending ? (t - firstEdge) / 1000.0 : 0;
+            report.delayTotal += delay;
+            report.delayMax = max(report.delayMax, delay);
+            pending = false;
+        } else if (pressed != button.isPressed()) {
+            if (!pending) {
+                firstEdge = t;
+                pending = true;
+            }
+            lastDiffer = t;
+        } else if (pending && t - lastDiffer >= options.debounce * 1000UL) {
+            //back where it was for a whole debounce time, so that was a glitch
+            pending = false;
+        }
+
+    }
+
+    player.stop();
+    report.filtered = report.rawEdges - report.presses - report.releases;
+    report.readNanos = report.reads ? nanos / report.reads : 0;
+
+    return report;
+
+}
+
+/**
+ * Parse pin[:channel].
+ */
+static void parseKey(const char *arg, int &pin, int &channel) {
+    pin = atoi(arg);
+    const char *colon = strchr(arg, ':');
+    channel = colon ? atoi(colon + 1) : TRACE_NO_CHANNEL;
+}
+
+static uint32_t duration(const std::vector<TraceSample> &samples) {
+    return samples.back().time - samples[0].time;
+}
+
+static int runPot(const std::vector<TraceSample> &samples, Options &options) {
+
+    Report report = replay(samples, options);
+    if (!report.reads) {
+        fprintf(stderr, "no samples for pin %d\n", options.pin);
+        return 1;
+    }
+
+    printf("trace:    %lu reads of pin %d over %.1f s\n", report.reads + 1, options.pin, duration(samples) / 1e6);
+    printf("config:   resolution %d, smoothing %.2f, time %u ms, noise floor %d\n",
+        options.resolution, options.smoothing, options.smoothingTime, options.noiseFloor);
+    printf("changes:  %lu (%lu spurious)\n", report.changes, report.spurious);
+    if (report.steps) {
+        printf("latency:  %lu steps, mean %.1f ms, max %.1f ms (%lu rests never settled)\n",
+            report.steps, report.latencyTotal / report.steps, report.latencyMax, report.unsettled);
+    } else {
+        printf("latency:  no steps found (%lu rests never settled)\n", report.unsettled);
+    }
+    printf("cpu:      %.0f ns per read (host)\n", report.readNanos);
+
+    return 0;
+
+}
+
+static int runJoystick(const std::vector<TraceSample> &samples, Options &options) {
+
+    //default to the first two pins in the trace
+    if (options.pinY < 0) {
+        for (const TraceSample &s : samples) {
+            if (s.pin != options.pin || s.channel != options.channel) {
+                options.pinY = s.pin;
+                options.channelY = s.channel;
+                break;
+            }
+        }
+    }
+    if ((options.channel == TRACE_NO_CHANNEL) != (options.channelY == TRACE_NO_CHANNEL)
+        || (options.channel != TRACE_NO_CHANNEL && options.pin != options.pinY)) {
+        fprintf(stderr, "a muxed joystick needs both axes on the same pin\n");
+        return 2;
+    }
+    if (options.thresholdStep <= 0 || options.thresholdFrom > options.thresholdTo) {
+        usage();
+        return 2;
+    }
+
+    std::vector<JoystickReport> reports;
+    for (int threshold=options.thresholdFrom; threshold<=options.thresholdTo; threshold+=options.thresholdStep) {
+        reports.push_back(replayJoystick(samples, options, threshold));
+    }
+    if (!reports[0].reads) {
+        fprintf(stderr, "no samples for pins %d and %d\n", options.pin, options.pinY);
+        return 1;
+    }
+
+    printf("trace:     %lu reads of pins %d (x) and %d (y) over %.1f s\n",
+        reports[0].reads + 1, options.pin, options.pinY, duration(samples) / 1e6);
+    printf("config:    %s dead zone, rest band %d\n", options.radial ? "radial" : "square", options.band);
+    printf("threshold  changes  spurious  outside  cpu (host)\n");
+    for (const JoystickReport &report : reports) {
+        printf("%9d  %7lu  %8lu  %6.1f%%  %4.0f ns\n",
+            report.threshold, report.changes, report.spurious, report.outside, report.readNanos);
+    }
+
+    return 0;
+
+}
+
+static int runButton(const std::vector<TraceSample> &samples, Options &options) {
+
+    ButtonReport report = replayButton(samples, options);
+    if (!report.reads) {
+        fprintf(stderr, "no samples for pin %d\n", options.pin);
+        return 1;
+    }
+
+    unsigned long changes = report.presses + report.releases;
+    printf("trace:    %lu reads of pin %d over %.1f s\n", report.reads + 1, options.pin, duration(samples) / 1e6);
+    printf("config:   debounce %u ms, pressed reads %s\n", options.debounce, options.activeHigh ? "high" : "low");
+    printf("edges:    %lu raw, %lu debounced (%lu presses, %lu releases), %lu bounces filtered out\n",
+        report.rawEdges, changes, report.presses, report.releases, report.filtered);
+    if (changes) {
+        printf("delay:    first raw edge to debounced edge, mean %.1f ms, max %.1f ms\n",
+            report.delayTotal / changes, report.delayMax);
+    }
+    printf("cpu:      %.0f ns per read (host)\n", report.readNanos);
+
+    return 0;
+
+}
+
+int main(int argc, char **argv) {
+
+    Options options;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:p:c:y:r:s:t:n:b:w:T:Rd:ih")) != -1) {
+        switch (opt) {
+            case 'm':
+                if (!strcmp(optarg, "pot")) options.mode = POT;
+                else if (!strcmp(optarg, "joystick")) options.mode = JOYSTICK;
+                else if (!strcmp(optarg, "button")) options.mode = BUTTON;
+                else { usage(); return 2; }
+                break;
+            case 'p': options.pin = atoi(optarg); break;
+            case 'c': options.channel = atoi(optarg); break;
+            case 'y': parseKey(optarg, options.pinY, options.channelY); break;
+            case 'r': options.resolution = atoi(optarg); break;
+            case 's': options.smoothing = atof(optarg); break;
+            case 't': options.smoothingTime = atoi(optarg); break;
+            case 'n': options.noiseFloor = atoi(optarg); break;
+            case 'b': options.band = atoi(optarg); break;
+            case 'w': options.restMicros = atol(optarg) * 1000; break;
+            case 'T':
+                if (sscanf(optarg, "%d:%d:%d", &options.thresholdFrom, &options.thresholdTo, &options.thresholdStep) != 3) {
+                    usage();
+                    return 2;
+                }
+                break;
+            case 'R': options.radial = true; break;
+            case 'd': options.debounce = atoi(optarg); break;
+            case 'i': options.activeHigh = true; break;
+            default: usage(); return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage();
+        return 2;
+    }
+
+    std::vector<TraceSample> samples;
+    if (!load(argv[optind], samples)) {
+        return 1;
+    }
+    if (samples.empty()) {
+        fprintf(stderr, "%s: no samples\n", argv[optind]);
+        return 1;
+    }
+    if (options.pin < 0) {
+        options.pin = samples[0].pin;
+        options.channel = samples[0].channel;
+    }
+
+    switch (options.mode) {
+        case JOYSTICK: return runJoystick(samples, options);
+        case BUTTON: return runButton(samples, options);
+        default: return runPot(samples, options);
+    }
+
+}
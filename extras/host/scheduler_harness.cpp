@@ -0,0 +1,199 @@
+/**
+ * Measures what ControlScheduler's decay saves, and what it costs.
+ *
+ * Runs a bank of simulated pots through a free-running loop, once with decay
+ * (the given maxInterval) and once without (every control read every poll).
+ * Each read costs a fixed number of simulated microseconds, as analogRead()
+ * does on the board, and each loop adds a fixed overhead. Every so often one
+ * quiet pot is moved, at a random moment, and the harness times how long it
+ * takes from the movement to the poll where changed() first fires.
+ *
+ * It reports the share of time spent in read() (CPU busy), overall and
+ * while every control is idle, and the wake-to-first-event latency, in
+ * milliseconds and in polls.
+ *
+ * Usage: scheduler_harness [options]
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include "Simple_Controls.h"
+
+static uint32_t simMicros = 0;
+
+static uint32_t simClockMillis() {
+    return simMicros / 1000;
+}
+
+static uint32_t simClockMicros() {
+    return simMicros;
+}
+
+/**
+ * A pot that counts its reads.
+ */
+class CountingPot : public Potentiometer {
+
+  public:
+
+    CountingPot(byte pin) : Potentiometer(pin, 0, 0, 1, 0) {}
+
+    boolean read() {
+      reads++;
+      return Potentiometer::read();
+    }
+
+    unsigned long reads = 0;
+
+};
+
+struct Options {
+    byte controls = 8;
+    unsigned int readCost = 112;
+    unsigned int loopCost = 100;
+    unsigned int idleTime = 1000;
+    unsigned int maxInterval = 64;
+    unsigned int events = 50;
+};
+
+struct Report {
+    double busy = 0;
+    double idleBusy = 0;
+    double latencyTotal = 0;
+    double latencyMax = 0;
+    double pollsTotal = 0;
+    unsigned long pollsMax = 0;
+    unsigned long events = 0;
+};
+
+static void usage() {
+    fprintf(stderr,
+        "Usage: scheduler_harness [options]\n"
+        "\n"
+        "  -c count     number of pots (default: 8, max 16)\n"
+        "  -r us        cost of one read (default: 112, an AVR analogRead)\n"
+        "  -l us        cost of the rest of the loop (default: 100)\n"
+        "  -i ms        scheduler idle time (default: 1000)\n"
+        "  -m ms        scheduler max interval (default: 64)\n"
+        "  -e count     number of movements to time (default: 50)\n");
+}
+
+/**
+ * Run the loop with the given max interval, 0 meaning no decay.
+ */
+static Report run(const Options &options, unsigned int maxInterval) {
+
+    Report report;
+    std::vector<CountingPot> pots;
+    ControlScheduler<16> scheduler(options.idleTime, maxInterval);
+
+    simMicros = 0;
+    srand(1);
+    pots.reserve(options.controls);
+    for (byte i=0; i<options.controls; i++) {
+        hostSetAnalog(A0 + i, 512);
+        pots.emplace_back(A0 + i);
+        pots[i].begin();
+        scheduler.add(pots[i]);
+    }
+
+    //long enough for everything to decay fully, plus a random phase
+    const uint32_t quiet = (options.idleTime + 8 * options.maxInterval) * 1000UL;
+    uint32_t next = quiet + rand() % (options.maxInterval * 1000 + 1);
+    uint32_t movedAt = 0;
+    unsigned long polls = 0;
+    uint32_t idleMicros = 0;
+    unsigned long idleReads = 0;
+    int moving = -1;
+
+    while (report.events < options.events) {
+
+        if (moving < 0 && (int32_t)(simMicros - next) >= 0) {
+            moving = rand() % options.controls;
+            hostSetAnalog(A0 + moving, analogRead(A0 + moving) == 512 ? 612 : 512);
+            movedAt = simMicros;
+            polls = 0;
+        }
+
+        unsigned long before = 0;
+        for (byte i=0; i<options.controls; i++) {
+            before += pots[i].reads;
+        }
+
+        boolean idle = scheduler.isIdle();
+        scheduler.poll();
+        polls++;
+
+        unsigned long reads = 0;
+        for (byte i=0; i<options.controls; i++) {
+            reads += pots[i].reads;
+        }
+        uint32_t spent = (reads - before) * options.readCost + options.loopCost;
+        simMicros += spent;
+        if (idle) {
+            idleReads += reads - before;
+            idleMicros += spent;
+        }
+
+        if (moving >= 0 && pots[moving].changed()) {
+            double latency = (simMicros - movedAt) / 1000.0;
+            report.latencyTotal += latency;
+            report.latencyMax = max(report.latencyMax, latency);
+            report.pollsTotal += polls;
+            report.pollsMax = max(report.pollsMax, polls);
+            report.events++;
+            moving = -1;
+            next = simMicros + quiet + rand() % (options.maxInterval * 1000 + 1);
+        }
+
+    }
+
+    unsigned long reads = 0;
+    for (byte i=0; i<options.controls; i++) {
+        reads += pots[i].reads;
+    }
+    report.busy = 100.0 * reads * options.readCost / simMicros;
+    report.idleBusy = idleMicros ? 100.0 * idleReads * options.readCost / idleMicros : report.busy;
+
+    return report;
+
+}
+
+static void print(const char *name, const Report &report) {
+    printf("%-11s cpu busy %.1f%% (%.1f%% while idle), first event after mean %.1f ms (%.1f polls), max %.1f ms (%lu polls)\n",
+        name, report.busy, report.idleBusy,
+        report.latencyTotal / report.events, report.pollsTotal / report.events,
+        report.latencyMax, report.pollsMax);
+}
+
+int main(int argc, char **argv) {
+
+    Options options;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:r:l:i:m:e:h")) != -1) {
+        switch (opt) {
+            case 'c': options.controls = atoi(optarg); break;
+            case 'r': options.readCost = atoi(optarg); break;
+            case 'l': options.loopCost = atoi(optarg); break;
+            case 'i': options.idleTime = atoi(optarg); break;
+            case 'm': options.maxInterval = atoi(optarg); break;
+            case 'e': options.events = atoi(optarg); break;
+            default: usage(); return 2;
+        }
+    }
+    if (options.controls < 1 || options.controls > 16 || options.events < 1) {
+        usage();
+        return 2;
+    }
+
+    Clock::setSource(simClockMillis, simClockMicros);
+
+    printf("config:     %u pots, %u us per read, %u us per loop, idle after %u ms, max interval %u ms\n",
+        options.controls, options.readCost, options.loopCost, options.idleTime, options.maxInterval);
+    print("no decay:", run(options, 0));
+    print("decayed:", run(options, options.maxInterval));
+
+    return 0;
+
+}
@@ -0,0 +1,242 @@
+/**
+ * Measures how long a Potentiometer takes to become stable after begin().
+ *
+ * Runs the same step input through each smoothing configuration, with and
+ * without a warm start, from begin() onwards. The input is either a power-on
+ * step (the pin rises from 0 to a resting value over a short time, with
+ * noise), or the start of a trace recorded with TraceRecorder.
+ *
+ * Every read moves the simulated clock on by the cost of an analogRead(), so
+ * the burst of a warm start takes time just as it does on the board. The pot
+ * is stable once it reports no more changes and stays within the band of the
+ * resting value. For each configuration it prints how many changes were
+ * reported on the way, and when it became stable.
+ *
+ * Usage: settle_harness [options] [trace.bin]
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+#include "Simple_Controls.h"
+
+struct Options {
+    int target = 600;
+    unsigned int rise = 2;
+    unsigned int noise = 2;
+    unsigned int period = 500;
+    unsigned int readCost = 112;
+    unsigned int duration = 1000;
+    int band = 0;
+    int pin = -1;
+    int channel = TRACE_NO_CHANNEL;
+};
+
+struct Config {
+    const char *name;
+    float factor;
+    unsigned int timeConstant;
+};
+
+static const Config CONFIGS[] = {
+    { "none",       0,    0  },
+    { "factor 0.6", 0.6,  0  },
+    { "factor 0.3", 0.3,  0  },
+    { "factor 0.15", 0.15, 0 },
+    { "time 30 ms", 0,    30 },
+    { "time 100 ms", 0,   100 },
+};
+
+static const byte WARM_STARTS[] = { 0, 8, 32 };
+
+static Options options;
+static std::vector<TraceSample> trace;
+static uint32_t simMicros = 0;
+
+static uint32_t simClockMillis() {
+    return simMicros / 1000;
+}
+
+static uint32_t simClockMicros() {
+    return simMicros;
+}
+
+/**
+ * The input at the current time. Each read takes time.
+ */
+static int readInput(uint8_t) {
+
+    uint32_t t = simMicros;
+    simMicros += options.readCost;
+
+    if (!trace.empty()) {
+        //last sample at or before now
+        size_t lo = 0, hi = trace.size();
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (trace[mid].time <= t) lo = mid; else hi = mid;
+        }
+        return trace[lo].value;
+    }
+
+    double settled = options.rise ? 1 - exp(-(double)t / (options.rise * 1000)) : 1;
+    int jitter = options.noise ? rand() % (2 * options.noise + 1) - (int)options.noise : 0;
+    return constrain((int)(options.target * settled + 0.5) + jitter, 0, Potentiometer::MAX);
+
+}
+
+static void usage() {
+    fprintf(stderr,
+        "Usage: settle_harness [options] [trace.bin]\n"
+        "\n"
+        "  -v value     resting value of the power-on step (default: 600)\n"
+        "  -r ms        how long the step takes to rise (time constant, default: 2)\n"
+        "  -n noise     +/- raw noise (default: 2)\n"
+        "  -p us        time between reads (default: 500)\n"
+        "  -c us        cost of one read (default: 112, an AVR analogRead)\n"
+        "  -d ms        how long to run (default: 1000, or the whole trace)\n"
+        "  -b band      raw units from the resting value that count as stable (default: noise floor, at least 2)\n"
+        "  -P pin       pin to take from the trace (default: first pin in the trace)\n");
+}
+
+/**
+ * Read a whole trace, keeping one pin, with times from the first sample.
+ */
+static bool load(const char *path) {
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    TraceDecoder decoder;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (decoder.push((byte)c)) {
+            const TraceSample &s = decoder.sample();
+            if (options.pin < 0) {
+                options.pin = s.pin;
+                options.channel = s.channel;
+            }
+            if (s.pin == options.pin && s.channel == options.channel) {
+                trace.push_back(s);
+            }
+        }
+        if (decoder.failed()) {
+            fprintf(stderr, "%s: not a trace, or corrupt\n", path);
+            fclose(file);
+            return false;
+        }
+    }
+    fclose(file);
+
+    if (trace.empty()) {
+        fprintf(stderr, "%s: no samples\n", path);
+        return false;
+    }
+
+    //rest on the mean of the last fifth
+    uint32_t start = trace[0].time;
+    long sum = 0;
+    size_t from = trace.size() * 4 / 5;
+    for (size_t i=0; i<trace.size(); i++) {
+        trace[i].time -= start;
+        if (i >= from) sum += trace[i].value;
+    }
+    options.target = sum / (long)(trace.size() - from);
+    options.duration = trace.back().time / 1000;
+    return true;
+
+}
+
+/**
+ * Run one configuration from begin().
+ *
+ * @return long Microseconds until stable, or -1 if it never was.
+ */
+static long run(const Config &config, byte warmStart, int band, unsigned long &changes) {
+
+    simMicros = 0;
+    srand(1);
+
+    Potentiometer pot(A0, 0, config.factor, 1, 0);
+    TimeConstantFilter filter(config.timeConstant);
+    if (config.timeConstant) {
+        pot.setSmoothingFilter(&filter);
+    }
+    pot.setNoiseFloor(2 * options.noise);
+    pot.setWarmStart(warmStart);
+    pot.begin();
+
+    uint32_t unstable = 0;
+    changes = 0;
+
+    while (simMicros < options.duration * 1000UL) {
+        simMicros += options.period;
+        if (pot.read()) {
+            changes++;
+            unstable = simMicros;
+        }
+        if (abs(pot.getRawValue() - options.target) > band) {
+            unstable = simMicros;
+        }
+    }
+
+    return abs(pot.getRawValue() - options.target) > band ? -1 : (long)unstable;
+
+}
+
+int main(int argc, char **argv) {
+
+    int opt;
+    while ((opt = getopt(argc, argv, "v:r:n:p:c:d:b:P:h")) != -1) {
+        switch (opt) {
+            case 'v': options.target = atoi(optarg); break;
+            case 'r': options.rise = atoi(optarg); break;
+            case 'n': options.noise = atoi(optarg); break;
+            case 'p': options.period = atoi(optarg); break;
+            case 'c': options.readCost = atoi(optarg); break;
+            case 'd': options.duration = atoi(optarg); break;
+            case 'b': options.band = atoi(optarg); break;
+            case 'P': options.pin = atoi(optarg); break;
+            default: usage(); return 2;
+        }
+    }
+    if (optind < argc - 1 || options.period == 0) {
+        usage();
+        return 2;
+    }
+    if (optind == argc - 1 && !load(argv[optind])) {
+        return 1;
+    }
+
+    Clock::setSource(simClockMillis, simClockMicros);
+    hostSetAnalogSource(readInput);
+    int band = options.band ? options.band : max(2 * (int)options.noise, (int)Potentiometer::WARM_START_BAND);
+
+    if (trace.empty()) {
+        printf("input:   0 to %d, rising over %u ms, noise +/-%u\n", options.target, options.rise, options.noise);
+    } else {
+        printf("input:   %zu samples of pin %d, resting at %d\n", trace.size(), options.pin, options.target);
+    }
+    printf("reads:   every %u us, %u us each, for %u ms, stable within %d\n",
+        options.period, options.readCost, options.duration, band);
+    printf("%-12s  warm  changes  stable after\n", "smoothing");
+
+    for (const Config &config : CONFIGS) {
+        for (byte warmStart : WARM_STARTS) {
+            unsigned long changes;
+            long stable = run(config, warmStart, band, changes);
+            if (stable < 0) {
+                printf("%-12s  %4u  %7lu  never\n", config.name, warmStart, changes);
+            } else {
+                printf("%-12s  %4u  %7lu  %7.1f ms\n", config.name, warmStart, changes, stable / 1000.0);
+            }
+        }
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Control.h"
+#include "SC_Joystick.h"
+
+/**
+ * A control with any number of analog axes, ie a 3-axis stick, an XY pad
+ * or a pair of foot pedals.
+ * 
+ * All axes are sampled back-to-back in a single burst and timestamped once,
+ * so the values are coherent with each other. With a Multiplexer, the axes 
+ * are read in ascending channel order. Each axis can have its own settle time 
+ * before it is read, for high impedance sources or slow mux settling.
+ * 
+ * Movement uses the same threshold logic as Joystick, per axis. Each axis 
+ * moves in the NEGATIVE or POSITIVE direction once it is more than threshold 
+ * away from its centre (read at begin()). With a radial dead zone, nothing
+ * moves until the stick is more than threshold from the centre in N dimensions,
+ * and then only the axes carrying at least half of the largest deflection do.
+ * 
+ * Usage:
+ * 
+ *   const byte pins[] = { A0, A1, A2 };
+ *   AnalogAxes<3> stick(pins);
+ *   ...
+ *   stick.read();
+ *   if (stick.moved(2, AnalogAxes<3>::POSITIVE)) { ... }
+ */
+template<byte N>
+class AnalogAxes : public Control {
+
+  static_assert(N > 0 && N <= 8, "AnalogAxes supports 1-8 axes");
+
+  public:
+
+    static constexpr int8_t NEGATIVE = -1;
+    static constexpr int8_t POSITIVE = 1;
+
+    /**
+     * Supply a pin for each axis.
+     */
+    AnalogAxes(const byte *pins, int threshold = Joystick::DEFAULT_THRESHOLD) : _threshold(threshold) {
+      for (byte i=0; i<N; i++) {
+        _pins[i] = pins[i];
+        _order[i] = i;
+      }
+    }
+
+    /**
+     * Mux version: all axes share a signal pin, with a mux channel each.
+     */
+    AnalogAxes(byte signalPin, Multiplexer *mux, const byte *channels, int threshold = Joystick::DEFAULT_THRESHOLD) : _threshold(threshold) {
+      setMultiplexer(mux, 0);
+      for (byte i=0; i<N; i++) {
+        _pins[i] = signalPin;
+        _channels[i] = channels[i];
+      }
+      _sortByChannel();
+    }
+
+    /**
+     * Microseconds to wait before reading an axis, after its mux channel is selected.
+     */
+    inline void setSettleTime(byte axis, byte us) { _settle[axis] = us; }
+
+    /**
+     * Use a circular (spherical, ...) dead zone instead of a separate one per axis.
+     */
+    inline void setRadialDeadZone(boolean radial) { _radial = radial; }
+
+    inline void setThreshold(int threshold) { _threshold = threshold; }
+    inline int getThreshold() { return _threshold; }
+
+    /**
+     * Initialise, saving the current position as the centre.
+     */
+    virtual void begin() {
+      _flags = 0;
+      _lastFlags = 0;
+      _time = Clock::now();
+      _lastChange = _time;
+      _readAxes();
+      for (byte i=0; i<N; i++) {
+        _centres[i] = _values[i];
+      }
+    }
+
+    /**
+     * Read every axis in one burst and test whether any direction has changed.
+     * 
+     * This should be called once in the Arduino loop().
+     * 
+     * @return boolean Whether the value has changed since last read.
+     */
+    virtual boolean read() {
+
+      _statsBeginRead();
+
+      _time = Clock::now();
+      _lastFlags = _flags;
+      _flags = 0;
+
+      _readAxes();
+
+      if (_radial) {
+        _radialFlags();
+      } else {
+        for (byte i=0; i<N; i++) {
+          _setDirection(i, Joystick::axisDirection(_values[i], _centres[i], _threshold));
+        }
+      }
+
+      _changed = _flags != _lastFlags;
+      if (_changed) {
+        _lastChange = _time;
+      }
+
+      _statsEndRead();
+
+      return _changed;
+
+    }
+
+    /**
+     * Current raw value of an axis.
+     */
+    inline int getValue(byte axis) { return _values[axis]; }
+
+    /**
+     * Distance of an axis from its centre.
+     */
+    inline int getDelta(byte axis) { return _values[axis] - _centres[axis]; }
+
+    /**
+     * Centre of an axis.
+     */
+    inline int getCentre(byte axis) { return _centres[axis]; }
+    inline void setCentre(byte axis, int centre) { _centres[axis] = centre; }
+
+    /**
+     * Direction an axis is currently moving: NEGATIVE, POSITIVE or 0.
+     */
+    inline int8_t direction(byte axis) {
+      byte bits = (_flags >> (axis * 2)) & 3;
+      return bits == 1 ? NEGATIVE : (bits == 2 ? POSITIVE : 0);
+    }
+
+    /**
+     * Whether an axis is currently moving in a direction.
+     */
+    inline boolean moving(byte axis, int8_t dir) { return direction(axis) == dir; }
+
+    /**
+     * Whether an axis started moving in a direction since the last read.
+     */
+    inline boolean moved(byte axis, int8_t dir) { return _changed && moving(axis, dir); }
+
+    /**
+     * Whether an axis has been moving in a direction for ms milliseconds.
+     */
+    inline boolean heldFor(byte axis, int8_t dir, uint32_t ms) { return moving(axis, dir) && _time - _lastChange > ms; }
+
+    /**
+     * Whether the value has changed since the last read.
+     */
+    inline boolean changed() { return _changed; }
+
+    /**
+     * Time of last change in millis (from Clock::now()).
+     */
+    inline uint32_t lastChange() { return _lastChange; }
+
+    /**
+     * Time the last burst of samples was taken, in micros (from Clock::nowMicros()).
+     */
+    inline uint32_t sampleTime() { return _sampleTime; }
+
+  protected:
+    byte _pins[N];
+    byte _channels[N] = {};
+    byte _order[N];
+    byte _settle[N] = {};
+    int _values[N];
+    int _centres[N];
+    int _threshold;
+    uint16_t _flags = 0, _lastFlags = 0;
+    uint32_t _time = 0, _lastChange = 0, _sampleTime = 0;
+    boolean _radial = false;
+
+    /**
+     * Read every axis back-to-back.
+     */
+    void _readAxes() {
+      _sampleTime = Clock::nowMicros();
+      _readBurst(N, _pins, _mux ? _channels : nullptr, _settle, _order, _values);
+    }
+
+    /**
+     * Read order that walks the mux channels upwards.
+     */
+    void _sortByChannel() {
+      for (byte i=0; i<N; i++) {
+        byte j = i;
+        while (j > 0 && _channels[_order[j - 1]] > _channels[i]) {
+          _order[j] = _order[j - 1];
+          j--;
+        }
+        _order[j] = i;
+      }
+    }
+
+    /**
+     * Set two bits per axis: 1 for negative, 2 for positive.
+     */
+    inline void _setDirection(byte axis, int8_t dir) {
+      if (dir) {
+        _flags |= (dir < 0 ? 1 : 2) << (axis * 2);
+      }
+    }
+
+    /**
+     * Flags for an N dimensional radial dead zone, compared squared to avoid sqrt.
+     */
+    void _radialFlags() {
+
+      long distance = 0;
+      int largest = 0;
+      for (byte i=0; i<N; i++) {
+        long d = _values[i] - _centres[i];
+        distance += d * d;
+        if (abs(d) > largest) largest = abs(d);
+      }
+
+      if (distance <= (long)_threshold * _threshold) {
+        return;
+      }
+
+      for (byte i=0; i<N; i++) {
+        int d = _values[i] - _centres[i];
+        if (abs(d) * 2 >= largest) {
+          _setDirection(i, d < 0 ? NEGATIVE : POSITIVE);
+        }
+      }
+
+    }
+
+};
+
+template<byte N> constexpr int8_t AnalogAxes<N>::NEGATIVE;
+template<byte N> constexpr int8_t AnalogAxes<N>::POSITIVE;
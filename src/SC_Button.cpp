@@ -13,7 +13,7 @@ void Button::begin() {
     _state = digitalRead(_pin);
     if (_invert) _state = !_state;
     _lastState = _state;
-    _time = millis();
+    _time = Clock::now();
     _lastChange = _time;
     _changed = false;
 }
@@ -24,7 +24,8 @@ void Button::begin() {
 /-----------------------------------------------------------------------*/
 boolean Button::read() {    
 
-    uint32_t ms = millis();
+    _statsBeginRead();
+    uint32_t ms = Clock::now();
     boolean pinVal = digitalRead(_pin);
     if (_invert) pinVal = !pinVal;
     if (ms - _lastChange < _dbTime) {
@@ -38,6 +39,7 @@ boolean Button::read() {
         }
     }
     _time = ms;
+    _statsEndRead();
     return _state;
 }
 
@@ -69,7 +69,7 @@ class Button : public Control
         // and has been in that state for at least the given number of milliseconds.
         boolean releasedFor(uint32_t ms);
 
-        // Returns the time in milliseconds (from millis) that the button last
+        // Returns the time in milliseconds (from Clock::now) that the button last
         // changed state.
         uint32_t lastChange();
 
@@ -85,7 +85,7 @@ class Button : public Control
         boolean _invert;       // if true, interpret logic low as pressed, else interpret logic high as pressed
         boolean _state;        // current button state, true=pressed
         boolean _lastState;    // previous button state
-        uint32_t _time;        // time of current state (ms from millis)
+        uint32_t _time;        // time of current state (ms from Clock::now)
         uint32_t _lastChange;  // time of last state change (ms)
         
 };
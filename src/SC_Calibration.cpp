@@ -0,0 +1,180 @@
+/**
+ * Saves and restores the calibration of a set of controls.
+ */
+
+#include "SC_Calibration.h"
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+constexpr byte CalibrationStore::VERSION;
+constexpr byte CalibrationStore::RECORD_SIZE;
+
+/**
+ * Save the calibration of every control.
+ */
+void CalibrationStore::save(Control **controls, byte count) {
+
+    int address = _address;
+    _writeByte(address++, 'S');
+    _writeByte(address++, 'C');
+    _writeByte(address++, VERSION);
+    _writeByte(address++, count);
+
+    CalibrationRecord record;
+    for (byte i=0; i<count; i++) {
+        controls[i]->saveCalibration(record);
+        _writeByte(address++, record.kind);
+        _writeByte(address++, record.noise);
+        for (byte v=0; v<6; v++) {
+            _writeWord(address, record.values[v]);
+            address += 2;
+        }
+    }
+
+    //checksum what was actually written
+    uint16_t crc = 0xFFFF;
+    for (int a=_address; a<address; a++) {
+        crc = _crc(crc, _readByte(a));
+    }
+    _writeWord(address, crc);
+
+}
+
+/**
+ * Restore the calibration of every control, if valid.
+ */
+boolean CalibrationStore::load(Control **controls, byte count) {
+
+    if (!isValid(count)) {
+        return false;
+    }
+
+    int address = _address + 4;
+    CalibrationRecord record;
+    for (byte i=0; i<count; i++) {
+        record.kind = _readByte(address++);
+        record.noise = _readByte(address++);
+        for (byte v=0; v<6; v++) {
+            record.values[v] = _readWord(address);
+            address += 2;
+        }
+        controls[i]->loadCalibration(record);
+    }
+
+    return true;
+
+}
+
+/**
+ * Whether a valid blob for this number of controls is stored.
+ */
+boolean CalibrationStore::isValid(byte count) {
+
+    if (_readByte(_address) != 'S' || _readByte(_address + 1) != 'C' 
+        || _readByte(_address + 2) != VERSION || _readByte(_address + 3) != count) {
+        return false;
+    }
+
+    int end = _address + size(count) - 2;
+    uint16_t crc = 0xFFFF;
+    for (int a=_address; a<end; a++) {
+        crc = _crc(crc, _readByte(a));
+    }
+
+    return crc == (uint16_t)_readWord(end);
+
+}
+
+/**
+ * CRC-16/CCITT, one byte at a time.
+ */
+uint16_t CalibrationStore::_crc(uint16_t crc, byte b) {
+    crc ^= (uint16_t)b << 8;
+    for (byte i=0; i<8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+int16_t CalibrationStore::_readWord(int address) {
+    return _readByte(address) | (_readByte(address + 1) << 8);
+}
+
+void CalibrationStore::_writeWord(int address, int16_t value) {
+    _writeByte(address, value & 0xFF);
+    _writeByte(address + 1, (value >> 8) & 0xFF);
+}
+
+#if defined(__AVR__)
+
+byte CalibrationStore::_readByte(int address) {
+    return eeprom_read_byte((const uint8_t *)address);
+}
+
+void CalibrationStore::_writeByte(int address, byte value) {
+    eeprom_update_byte((uint8_t *)address, value);
+}
+
+#else
+
+//no EEPROM: subclasses must provide storage, see FileCalibrationStore for host builds
+byte CalibrationStore::_readByte(int address) {
+    (void)address;
+    return 0xFF;
+}
+
+void CalibrationStore::_writeByte(int address, byte value) {
+    (void)address;
+    (void)value;
+}
+
+#endif
+
+#if !defined(ARDUINO)
+
+/**
+ * Open the file, creating it if missing.
+ */
+FileCalibrationStore::FileCalibrationStore(const char *path, int address) : CalibrationStore(address) {
+    _file = fopen(path, "r+b");
+    if (!_file) {
+        _file = fopen(path, "w+b");
+    }
+}
+
+FileCalibrationStore::~FileCalibrationStore() {
+    if (_file) {
+        fclose(_file);
+    }
+}
+
+/**
+ * Read a byte, or 0xFF past the end of the file.
+ */
+byte FileCalibrationStore::_readByte(int address) {
+    if (!_file || fseek(_file, address, SEEK_SET) != 0) {
+        return 0xFF;
+    }
+    int b = fgetc(_file);
+    return b == EOF ? 0xFF : b;
+}
+
+/**
+ * Write a byte, padding the file with 0xFF up to it.
+ */
+void FileCalibrationStore::_writeByte(int address, byte value) {
+    if (!_file) {
+        return;
+    }
+    fseek(_file, 0, SEEK_END);
+    for (long size = ftell(_file); size < address; size++) {
+        fputc(0xFF, _file);
+    }
+    fseek(_file, address, SEEK_SET);
+    fputc(value, _file);
+    fflush(_file);
+}
+
+#endif
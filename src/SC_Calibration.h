@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Control.h"
+
+/**
+ * Saves and restores the calibration of a set of controls, so begin()
+ * can start from a known-good state instead of settling at every boot.
+ * 
+ * The blob is versioned and CRC checked, so a blank or stale EEPROM is
+ * ignored rather than loaded:
+ * 
+ *   'S' 'C' VERSION count [record] * count CRC16
+ * 
+ * Each record is 14 bytes. By default the blob is stored in the AVR EEPROM.
+ * Override _readByte() and _writeByte() to store it somewhere else. Host
+ * builds (without ARDUINO defined) get FileCalibrationStore, which keeps
+ * it in a file.
+ * 
+ * Usage:
+ * 
+ *   Control *controls[] = { &joystick, &pot1, &pot2 };
+ *   CalibrationStore store;
+ *   
+ *   void setup() {
+ *     store.load(controls, 3);
+ *     joystick.begin();
+ *     ...
+ *   }
+ *   
+ *   //after calibrating
+ *   store.save(controls, 3);
+ */
+class CalibrationStore {
+
+  public:
+
+    static constexpr byte VERSION = 1;
+    static constexpr byte RECORD_SIZE = 2 + 6 * 2;
+
+    /**
+     * @param int address (Optional) Where the blob starts. Default is 0.
+     */
+    CalibrationStore(int address = 0) : _address(address) {}
+
+    /**
+     * Bytes used to store a number of controls.
+     */
+    static constexpr int size(byte count) {
+      return 4 + count * RECORD_SIZE + 2;
+    }
+
+    /**
+     * Save the calibration of every control.
+     */
+    void save(Control **controls, byte count);
+
+    /**
+     * Restore the calibration of every control, if a valid blob
+     * for the same number of controls is stored. Call before begin().
+     * 
+     * @return boolean Whether the calibration was restored.
+     */
+    boolean load(Control **controls, byte count);
+
+    /**
+     * Whether a valid blob for this number of controls is stored.
+     */
+    boolean isValid(byte count);
+
+  protected:
+    int _address;
+
+    /**
+     * Storage access. Defaults to the AVR EEPROM.
+     */
+    virtual byte _readByte(int address);
+    virtual void _writeByte(int address, byte value);
+
+    static uint16_t _crc(uint16_t crc, byte b);
+    int16_t _readWord(int address);
+    void _writeWord(int address, int16_t value);
+
+};
+
+#if !defined(ARDUINO)
+
+#include <stdio.h>
+
+/**
+ * CalibrationStore backed by a file, acting as a fake EEPROM for host builds.
+ * 
+ * The file is created if missing. Bytes past the end of the file read as 
+ * 0xFF, like a blank EEPROM, and writes past the end pad it with 0xFF.
+ */
+class FileCalibrationStore : public CalibrationStore {
+
+  public:
+
+    /**
+     * @param const char* path File to keep the blob in.
+     * @param int address (Optional) Where the blob starts in the file. Default is 0.
+     */
+    FileCalibrationStore(const char *path, int address = 0);
+    ~FileCalibrationStore();
+
+    /**
+     * Whether the file could be opened.
+     */
+    inline boolean isOpen() { return _file != nullptr; }
+
+  protected:
+    FILE *_file;
+
+    virtual byte _readByte(int address);
+    virtual void _writeByte(int address, byte value);
+
+};
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * Shared time source for all controls.
+ */
+
+#include "SC_Clock.h"
+
+Clock::Source Clock::_millisSource = Clock::_defaultMillis;
+Clock::Source Clock::_microsSource = Clock::_defaultMicros;
+uint32_t Clock::_millis = 0;
+uint32_t Clock::_micros = 0;
+boolean Clock::_ticking = false;
+
+/**
+ * Replace the time source.
+ */
+void Clock::setSource(Source millisSource, Source microsSource) {
+    _millisSource = millisSource ? millisSource : _defaultMillis;
+    _microsSource = microsSource ? microsSource : _defaultMicros;
+}
+
+/**
+ * Capture the time for this scan.
+ */
+void Clock::tick() {
+    _millis = _millisSource();
+    _micros = _microsSource();
+    _ticking = true;
+}
+
+uint32_t Clock::_defaultMillis() {
+    return millis();
+}
+
+uint32_t Clock::_defaultMicros() {
+    return micros();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Shared time source for all controls.
+ * 
+ * By default, now() and nowMicros() simply return millis() and micros().
+ * 
+ * Call tick() once at the start of each scan to capture a single timestamp,
+ * which every control read in that scan will then share. This is cheaper than
+ * each control calling millis(), and keeps the controls consistent with each
+ * other. Once tick() has been called it must be called every scan, or use
+ * release() to go back to live time. ControlScheduler::poll() ticks for its
+ * own scan and releases again when it is done (see ClockScan).
+ * 
+ * setSource() replaces millis()/micros(), ie with a test clock on a PC or to 
+ * replay recorded timestamps.
+ * 
+ * All times are 32 bit and wrap around after ~49 days (millis) or ~71 minutes
+ * (micros). Always compare times by subtracting, as in elapsed() and reached(),
+ * which stay correct across the wraparound.
+ */
+class Clock {
+
+  public:
+
+    typedef uint32_t (*Source)();
+
+    /**
+     * Replace the time source.
+     * 
+     * @param Source millisSource Returns milliseconds, or nullptr for millis().
+     * @param Source microsSource (Optional) Returns microseconds, or nullptr for micros().
+     */
+    static void setSource(Source millisSource, Source microsSource = nullptr);
+
+    /**
+     * Capture the time for this scan.
+     */
+    static void tick();
+
+    /**
+     * Stop using the captured time, and read the source every time.
+     */
+    static inline void release() { _ticking = false; }
+
+    /**
+     * Whether a captured time is in use.
+     */
+    static inline boolean isTicking() { return _ticking; }
+
+    /**
+     * Current time in milliseconds.
+     */
+    static inline uint32_t now() { return _ticking ? _millis : _millisSource(); }
+
+    /**
+     * Current time in microseconds, for high-rate scanning.
+     */
+    static inline uint32_t nowMicros() { return _ticking ? _micros : _microsSource(); }
+
+    /**
+     * Milliseconds since a time.
+     */
+    static inline uint32_t elapsed(uint32_t since) { return now() - since; }
+
+    /**
+     * Whether a deadline has been reached. Deadlines must be less than ~24 days away.
+     */
+    static inline boolean reached(uint32_t deadline) { return (int32_t)(now() - deadline) >= 0; }
+
+  protected:
+    static Source _millisSource;
+    static Source _microsSource;
+    static uint32_t _millis;
+    static uint32_t _micros;
+    static boolean _ticking;
+
+    static uint32_t _defaultMillis();
+    static uint32_t _defaultMicros();
+
+};
+
+/**
+ * Captures the Clock time for one scan, and goes back to live time when
+ * it goes out of scope.
+ *
+ * If the Clock is already ticking (ie the sketch calls Clock::tick() at the
+ * start of loop()), that time is kept and nothing is released.
+ *
+ *   void readAll() {
+ *     ClockScan scan;
+ *     pot1.read();
+ *     pot2.read();
+ *   }
+ */
+class ClockScan {
+
+  public:
+
+    ClockScan() : _owner(!Clock::isTicking()) {
+      if (_owner) {
+        Clock::tick();
+      }
+    }
+
+    ~ClockScan() {
+      if (_owner) {
+        Clock::release();
+      }
+    }
+
+  protected:
+    boolean _owner;
+
+};
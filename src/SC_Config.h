@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+ * Compile-time options.
+ *
+ * The Arduino IDE compiles libraries separately from the sketch, so defining
+ * these in the sketch has no effect. Either change the defaults here, or pass
+ * them as build flags (ie build_flags = -DSC_ENABLE_STATS=1 in PlatformIO).
+ */
+
+/**
+ * Per-control read counters and timing statistics.
+ *
+ * When disabled, the statistics cost no RAM, flash or cycles.
+ */
+#ifndef SC_ENABLE_STATS
+#define SC_ENABLE_STATS 0
+#endif
+
+/**
+ * Raw sample tracing: record every analogRead/digitalRead made by a control
+ * to a compact binary stream, or replay a recorded stream through the controls.
+ *
+ * When disabled, tracing costs no RAM, flash or cycles.
+ */
+#ifndef SC_ENABLE_TRACE
+#define SC_ENABLE_TRACE 0
+#endif
@@ -1,6 +1,19 @@
 #pragma once
 
 #include <SC_Multiplexer.h>
+#include "SC_Config.h"
+#include "SC_Clock.h"
+#include "SC_Stats.h"
+#include "SC_Trace.h"
+
+/**
+ * Calibration state of a single control, as saved by CalibrationStore.
+ */
+struct CalibrationRecord {
+    byte kind;            // type of control that saved the record, 0 if none
+    byte noise;           // measured noise floor
+    int16_t values[6];    // control-specific values
+};
 
 /**
  * Mux-aware base class.
@@ -14,17 +27,33 @@ class Control {
         /**
          * Initialize a control object and the pin it's connected to.
          */ 
-        virtual void begin();
+        virtual void begin() = 0;
 
         /**
          * Read the pin and update internal state.
          */ 
-        virtual boolean read();        
+        virtual boolean read() = 0;
 
         /**
          * Whether the value has changed since the last read.
          */
-        virtual boolean changed();
+        virtual boolean changed() { return _changed; }
+
+        /**
+         * Fill in a record with this control's calibration.
+         * Controls without calibration leave it empty.
+         */
+        virtual void saveCalibration(CalibrationRecord &record) {
+            record = CalibrationRecord();
+        }
+
+        /**
+         * Restore calibration from a record. Call before begin().
+         * Records saved by a different type of control are ignored.
+         */
+        virtual void loadCalibration(const CalibrationRecord &record) {
+            (void)record;
+        }
 
         /**
          * Use Multiplexer when reading pin.
@@ -34,17 +63,39 @@ class Control {
             _muxChannel = channel;            
         }
 
+#if SC_ENABLE_STATS
+
+        /**
+         * Instrumentation counters for this control.
+         */
+        inline const ControlStats &getStats() { return _stats; }
+
+        /**
+         * Clear the instrumentation counters.
+         */
+        inline void resetStats() { _stats.reset(); }
+
+        /**
+         * Dump the instrumentation counters, ie to Serial.
+         */
+        inline void printStats(Print &out) { _stats.printTo(out); }
+
+#endif
+
     protected:
         byte _muxChannel = 0;
         Multiplexer *_mux = nullptr;
         boolean _changed = false;
+#if SC_ENABLE_STATS
+        ControlStats _stats;
+#endif
 
         /**
          * Overloaded to apply mux channel first.
          */ 
         int digitalRead(uint8_t pin) {
             applyChannel();
-            return ::digitalRead(pin);
+            return _trace(pin, ::digitalRead(pin));
         }
 
         /**
@@ -60,7 +111,7 @@ class Control {
          */ 
         int analogRead(uint8_t pin) {
             applyChannel();
-            return ::analogRead(pin);
+            return _trace(pin, ::analogRead(pin));
         }
 
         /**
@@ -77,7 +128,73 @@ class Control {
         void applyChannel() {
             if (_mux) {
                 _mux->setChannel(_muxChannel);
+#if SC_ENABLE_STATS
+                _stats.muxSwitches++;
+#endif
+            }
+        }
+
+        /**
+         * Instrumentation hooks, compiled away when SC_ENABLE_STATS is off.
+         */ 
+        inline void _statsBeginRead() {
+#if SC_ENABLE_STATS
+            _stats.beginRead();
+#endif
+        }
+
+        inline void _statsEndRead() {
+#if SC_ENABLE_STATS
+            _stats.endRead(_changed);
+#endif
+        }
+
+        /**
+         * Record a sample, or replace it with a recorded one.
+         * Compiled away when SC_ENABLE_TRACE is off.
+         */ 
+        inline int _trace(uint8_t pin, int value) {
+#if SC_ENABLE_TRACE
+            byte channel = _mux ? _muxChannel : TRACE_NO_CHANNEL;
+            if (Trace::player) {
+                return Trace::player->read(pin, channel);
+            }
+            if (Trace::recorder) {
+                Trace::recorder->record(pin, channel, value);
+            }
+#else
+            (void)pin;
+#endif
+            return value;
+        }
+
+        /**
+         * Read analog pins back-to-back, so the values belong together (ie all
+         * the axes of a stick). With channels, each read first selects its own
+         * mux channel. settle gives microseconds to wait before each read, and
+         * order the order to read them in (ie ascending channels). channels, 
+         * settle and order may each be nullptr.
+         */
+        void _readBurst(byte count, const byte *pins, const byte *channels, const byte *settle, const byte *order, int *values) {
+            for (byte n=0; n<count; n++) {
+                byte i = order ? order[n] : n;
+                if (channels) {
+                    _muxChannel = channels[i];
+                }
+                applyChannel();
+                if (settle && settle[i]) {
+                    delayMicroseconds(settle[i]);
+                }
+                values[i] = _trace(pins[i], ::analogRead(pins[i]));
             }
         }
 
+        inline void _statsNoise(int value) {
+#if SC_ENABLE_STATS
+            _stats.recordNoise(value, _changed);
+#else
+            (void)value;
+#endif
+        }
+
 };
@@ -0,0 +1,15 @@
+/**
+ * Built-in response curves for Potentiometer::setResponseCurve().
+ * 
+ * Generated from y = (81^x - 1) / 80 and its inverse, scaled to 0-1023.
+ */
+
+#include "SC_Curves.h"
+
+const uint16_t CURVE_EXPONENTIAL[CURVE_POINTS] PROGMEM = {
+    0, 4, 9, 16, 26, 38, 54, 75, 102, 139, 187, 250, 332, 442, 585, 774, 1023
+};
+
+const uint16_t CURVE_LOGARITHMIC[CURVE_POINTS] PROGMEM = {
+    0, 417, 558, 645, 709, 758, 799, 834, 864, 891, 915, 937, 957, 975, 992, 1008, 1023
+};
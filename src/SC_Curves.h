@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Built-in response curves for Potentiometer::setResponseCurve().
+ * 
+ * Curves are piecewise-linear tables in PROGMEM, with points evenly spaced
+ * over the raw range 0-1023 and output values also in 0-1023. Any table of 
+ * 2 or more points in the same format can be used as a custom curve.
+ */
+
+/**
+ * Number of points in the built-in curves.
+ */
+static constexpr byte CURVE_POINTS = 17;
+
+/**
+ * Exponential response, the same shape as an audio (log) taper pot, 
+ * with 10% output at the midpoint. Good for filter cutoff or volume
+ * on a linear pot.
+ */
+extern const uint16_t CURVE_EXPONENTIAL[CURVE_POINTS] PROGMEM;
+
+/**
+ * Logarithmic response, the inverse of CURVE_EXPONENTIAL. Use it to make 
+ * an audio taper pot read linearly.
+ */
+extern const uint16_t CURVE_LOGARITHMIC[CURVE_POINTS] PROGMEM;
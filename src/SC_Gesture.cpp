@@ -0,0 +1,159 @@
+/**
+ * Gesture recognition for buttons.
+ */
+
+#include "SC_Gesture.h"
+
+namespace {
+
+    enum State : byte { IDLE, FIRST_DOWN, DOWN, UP_WAIT, HELD, SUPPRESSED };
+    enum Action : byte { NO_ACTION, FIRST_COUNT, COUNT, EMIT_CLICKS, EMIT_LONG, EMIT_REPEAT };
+    enum Timer : byte { KEEP, OFF, LONG_TIMER, MULTI_TIMER, REPEAT_TIMER };
+
+    struct Transition {
+        byte next;
+        byte action;
+        byte timer;
+    };
+
+    /**
+     * Transition table, by state then input (press, release, timeout).
+     * 
+     * The first click of a gesture restarts the count on release rather 
+     * than on press, so clicks() still holds the last count while a press 
+     * that follows a timeout straight away is handled.
+     */
+    const Transition TRANSITIONS[6][3] PROGMEM = {
+        /* IDLE */       { { FIRST_DOWN, NO_ACTION, LONG_TIMER }, { IDLE, NO_ACTION, KEEP },    { IDLE, NO_ACTION, OFF } },
+        /* FIRST_DOWN */ { { FIRST_DOWN, NO_ACTION, KEEP },  { UP_WAIT, FIRST_COUNT, MULTI_TIMER }, { HELD, EMIT_LONG, REPEAT_TIMER } },
+        /* DOWN */       { { DOWN, NO_ACTION, KEEP },        { UP_WAIT, COUNT, MULTI_TIMER },  { HELD, EMIT_LONG, REPEAT_TIMER } },
+        /* UP_WAIT */    { { DOWN, NO_ACTION, LONG_TIMER },  { UP_WAIT, NO_ACTION, KEEP },     { IDLE, EMIT_CLICKS, OFF } },
+        /* HELD */       { { HELD, NO_ACTION, KEEP },        { IDLE, NO_ACTION, OFF },         { HELD, EMIT_REPEAT, REPEAT_TIMER } },
+        /* SUPPRESSED */ { { SUPPRESSED, NO_ACTION, KEEP },  { IDLE, NO_ACTION, OFF },         { SUPPRESSED, NO_ACTION, OFF } }
+    };
+
+}
+
+/**
+ * Feed the button's latest state into the recognizer.
+ */
+ButtonGesture::Event ButtonGesture::update(Button &button, const GestureTiming &timing) {
+
+    //check the timer as of the edge, if there is one
+    boolean edge = button.changed();
+    uint16_t now = edge ? button.lastChange() : Clock::now();
+
+    Event event = NONE;
+    if (_armed && (int16_t)(now - _deadline) >= 0) {
+        event = _input(TIMEOUT, timing);
+    }
+
+    //edges never complete a gesture, so this can't replace the event
+    if (edge) {
+        _input(button.isPressed() ? PRESS : RELEASE, timing);
+    }
+
+    return event;
+
+}
+
+/**
+ * Ignore the button until it is released.
+ */
+void ButtonGesture::suppress() {
+    _state = SUPPRESSED;
+    _armed = false;
+    _clicks = 0;
+}
+
+/**
+ * Run one transition of the table.
+ */
+ButtonGesture::Event ButtonGesture::_input(Input input, const GestureTiming &timing) {
+
+    const Transition *t = &TRANSITIONS[_state][input];
+    byte action = pgm_read_byte(&t->action);
+    byte timer = pgm_read_byte(&t->timer);
+    _state = pgm_read_byte(&t->next);
+
+    //restart or stop the timer
+    uint16_t duration = 0;
+    switch (timer) {
+        case KEEP:          break;
+        case OFF:           _armed = false; break;
+        case LONG_TIMER:    duration = timing.longPress; _armed = true; break;
+        case MULTI_TIMER:   duration = timing.multiClick; _armed = true; break;
+        case REPEAT_TIMER:  duration = timing.repeat; _armed = timing.repeat > 0; break;
+    }
+    if (timer > OFF) {
+        _deadline = (uint16_t)Clock::now() + duration;
+    }
+
+    Event event = NONE;
+    switch (action) {
+        case FIRST_COUNT:
+            _clicks = 1;
+            break;
+        case COUNT:
+            if (_clicks < 15) _clicks++;
+            break;
+        case EMIT_CLICKS:
+            event = _clicks >= 3 ? MULTI_CLICK : _clicks == 2 ? DOUBLE_CLICK : CLICK;
+            break;
+        case EMIT_LONG:
+            _clicks = 0;
+            event = LONG_PRESS;
+            break;
+        case EMIT_REPEAT:
+            event = REPEAT;
+            break;
+    }
+
+    return event;
+
+}
+
+/**
+ * Handle one button. Only does any work on an edge or when its timer expires.
+ */
+void GestureBankBase::_update(byte index, Button &button, ButtonGesture &gesture) {
+
+    if (button.changed() && index < 32) {
+        uint32_t mask = (uint32_t)1 << index;
+        if (button.isPressed()) {
+            _pressed |= mask;
+            _chordCheck = _chordCount > 0;
+        } else {
+            _pressed &= ~mask;
+        }
+    }
+
+    ButtonGesture::Event event = gesture.update(button, timing);
+    if (event != ButtonGesture::NONE && _handler) {
+        _handler(index, event, gesture.clicks());
+    }
+
+}
+
+/**
+ * Check whether a press completed a chord.
+ */
+void GestureBankBase::_checkChords(ButtonGesture *gestures, byte count) {
+
+    _chordCheck = false;
+
+    for (byte c=0; c<_chordCount; c++) {
+        if (_pressed == _chords[c]) {
+            for (byte i=0; i<count && i<32; i++) {
+                if (_chords[c] & ((uint32_t)1 << i)) {
+                    gestures[i].suppress();
+                }
+            }
+            if (_handler) {
+                _handler(c, ButtonGesture::CHORD, 0);
+            }
+            return;
+        }
+    }
+
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Button.h"
+#include "SC_Clock.h"
+
+/**
+ * Timings used to recognise gestures, in milliseconds.
+ */
+struct GestureTiming {
+  uint16_t multiClick = 250;  // longest gap between clicks of a double/multi click, 0 to disable
+  uint16_t longPress = 500;   // hold time before a long press
+  uint16_t repeat = 100;      // interval between repeats while held after a long press, 0 to disable
+};
+
+/**
+ * Recognises clicks, double clicks, multi clicks, long presses and repeats
+ * on a single button, using 3 bytes of state.
+ * 
+ * Runs a small transition table, and only does any work when the button 
+ * changes or a timer expires. Call update() after the button has been read.
+ * 
+ * Usage:
+ * 
+ *   ButtonGesture gesture;
+ *   ...
+ *   button.read();
+ *   switch (gesture.update(button)) {
+ *     case ButtonGesture::CLICK: ...
+ *     case ButtonGesture::DOUBLE_CLICK: ...
+ *     case ButtonGesture::LONG_PRESS: ...
+ *   }
+ */
+class ButtonGesture {
+
+  public:
+
+    ButtonGesture() : _state(0), _armed(0), _clicks(0), _deadline(0) {}
+
+    enum Event : byte { 
+      NONE,
+      CLICK,          // single click, after the multi click time has passed
+      DOUBLE_CLICK,   // two clicks
+      MULTI_CLICK,    // three or more clicks, see clicks()
+      LONG_PRESS,     // held for the long press time
+      REPEAT,         // still held, every repeat interval after a long press
+      CHORD           // (GestureBank only) a registered chord was pressed
+    };
+
+    /**
+     * Feed the button's latest state into the recognizer.
+     * 
+     * A timer that ran out before the button's latest edge fires first, so 
+     * a press after the multi click time starts a new gesture even if 
+     * update() was not called in between.
+     * 
+     * @return Event Gesture completed by this update, if any.
+     */
+    Event update(Button &button, const GestureTiming &timing = GestureTiming());
+
+    /**
+     * Number of clicks in the last click event.
+     */
+    inline byte clicks() { return _clicks; }
+
+    /**
+     * Ignore the button until it is released, ie when it was part of a chord.
+     */
+    void suppress();
+
+    /**
+     * Whether a timer is running.
+     */
+    inline boolean isArmed() { return _armed; }
+
+  protected:
+
+    enum Input : byte { PRESS, RELEASE, TIMEOUT };
+
+    byte _state : 3;
+    byte _armed : 1;
+    byte _clicks : 4;
+    uint16_t _deadline;
+
+    /**
+     * Run one transition of the table.
+     */
+    Event _input(Input input, const GestureTiming &timing);
+
+};
+
+/**
+ * Non-template part of GestureBank.
+ */
+class GestureBankBase {
+
+  public:
+
+    /**
+     * Called for every gesture. For CHORD events, index is the chord
+     * number from addChord(), otherwise the button index.
+     */
+    typedef void (*Handler)(byte index, ButtonGesture::Event event, byte clicks);
+
+    /**
+     * Timings shared by every button in the bank.
+     */
+    GestureTiming timing;
+
+  protected:
+
+    /**
+     * Handle one button. Only does any work on an edge or when its timer expires.
+     */
+    void _update(byte index, Button &button, ButtonGesture &gesture);
+
+    /**
+     * Check whether a press completed a chord.
+     */
+    void _checkChords(ButtonGesture *gestures, byte count);
+
+    Handler _handler = nullptr;
+    uint32_t _chords[4];
+    uint32_t _pressed = 0;
+    byte _chordCount = 0;
+    boolean _chordCheck = false;
+
+};
+
+/**
+ * Gestures for a bank of buttons, with chords.
+ * 
+ * A chord is a set of buttons pressed together. When the last button of a 
+ * chord goes down, a CHORD event is sent and each button in it is ignored
+ * until released, so no click or long press is sent for them. Only the first
+ * 32 buttons can be part of a chord.
+ * 
+ * Usage:
+ * 
+ *   Button *buttons[] = { &a, &b, &c };
+ *   GestureBank<3> gestures(buttons, onGesture);
+ *   gestures.addChord(bit(0) | bit(1));
+ *   ...
+ *   void loop() {
+ *     a.read(); b.read(); c.read();
+ *     gestures.update();
+ *   }
+ */
+template<byte N>
+class GestureBank : public GestureBankBase {
+
+  public:
+
+    GestureBank(Button **buttons, Handler handler) : _buttons(buttons) {
+      _handler = handler;
+    }
+
+    /**
+     * Register a chord as a bit mask of button indexes.
+     * 
+     * @return boolean False if 4 chords are already registered.
+     */
+    boolean addChord(uint32_t mask) {
+      if (_chordCount >= 4) {
+        return false;
+      }
+      _chords[_chordCount++] = mask;
+      return true;
+    }
+
+    /**
+     * Process every button. Call after the buttons have been read.
+     */
+    void update() {
+      for (byte i=0; i<N; i++) {
+        _update(i, *_buttons[i], _gestures[i]);
+      }
+      if (_chordCheck) {
+        _checkChords(_gestures, N);
+      }
+    }
+
+  protected:
+    Button **_buttons;
+    ButtonGesture _gestures[N];
+
+};
@@ -13,17 +13,69 @@
 
 #include "SC_Joystick.h"
 
+constexpr int  Joystick::DEFAULT_THRESHOLD;
+constexpr byte Joystick::LEFT;
+constexpr byte Joystick::RIGHT;
+constexpr byte Joystick::UP;
+constexpr byte Joystick::DOWN;
+constexpr int  Joystick::ADC_MAX;
+constexpr int  Joystick::NORMALIZED_MAX;
+constexpr size_t Joystick::RAM_BUDGET;
+constexpr byte Joystick::NO_DIRECTION;
+constexpr byte Joystick::RADIAL;
+constexpr byte Joystick::LEARN_RANGE;
+constexpr byte Joystick::CALIBRATED;
+constexpr byte Joystick::TRACK_CENTRE;
+constexpr byte Joystick::CALIBRATION_KIND;
+
+/**
+ * atan(i/32) as a binary angle (256 = full circle), for i = 0-32.
+ */
+static const byte ATAN_TABLE[33] PROGMEM = {
+    0, 1, 3, 4, 5, 6, 8, 9, 10, 11, 12, 13, 15, 16, 17, 18, 
+    19, 20, 21, 22, 23, 24, 25, 25, 26, 27, 28, 29, 29, 30, 31, 31, 
+    32
+};
+
+/**
+ * Direction flags for each of the 8 sectors, starting at the right and going anti-clockwise.
+ */
+static const byte SECTOR_FLAGS[8] PROGMEM = {
+    Joystick::RIGHT,
+    Joystick::RIGHT | Joystick::UP,
+    Joystick::UP,
+    Joystick::UP | Joystick::LEFT,
+    Joystick::LEFT,
+    Joystick::LEFT | Joystick::DOWN,
+    Joystick::DOWN,
+    Joystick::DOWN | Joystick::RIGHT
+};
+
 /**
  * Saves the current x/y as the centre.
  */
 void Joystick::begin() { 
+    static_assert(sizeof(Joystick) <= RAM_BUDGET, "Joystick exceeds its RAM budget");
     _lastFlags = 0;
     _flags = 0;
-    _time = millis();
+    _time = Clock::now();
     _lastChange = _time;
     _readPins();
-    _centreX = _x;
-    _centreY = _y;
+    if (!(_options & CALIBRATED)) {
+        _centreX = _x;
+        _centreY = _y;
+        //learn the range outwards from the centre
+        if (_options & LEARN_RANGE) {
+            _minX = _maxX = _x;
+            _minY = _maxY = _y;
+        }
+    }
+    _centreQ4X = _centreX << 4;
+    _centreQ4Y = _centreY << 4;
+    _lastX = _x;
+    _lastY = _y;
+    _driftTime = _time;
+    _resetMotion();
 }
 
 /**
@@ -33,8 +85,10 @@ void Joystick::begin() {
  */
 boolean Joystick::read() {
 
+    _statsBeginRead();
+
     //get time of read
-    _time = millis();
+    _time = Clock::now();
 
     //save last state
     _lastFlags = _flags;
@@ -42,20 +96,56 @@ boolean Joystick::read() {
 
     //read the pins
     _readPins();
+    if (_motionX || _motionY) {
+        uint32_t us = Clock::nowMicros();
+        if (_motionX) _motionX->update(_x, us);
+        if (_motionY) _motionY->update(_y, us);
+    }
+
+    //widen the calibrated range if learning
+    if (_options & LEARN_RANGE) {
+        if (_x < _minX) _minX = _x;
+        if (_x > _maxX) _maxX = _x;
+        if (_y < _minY) _minY = _y;
+        if (_y > _maxY) _maxY = _y;
+    }
+
+    if (_options & RADIAL) {
+
+        //circular dead zone, compared squared to avoid sqrt
+        long dx = _x - _centreX;
+        long dy = _y - _centreY;
+        if (dx * dx + dy * dy > (long)_threshold * _threshold) {
+            byte sector = (byte)(_angleOf(dx, dy) + 16) >> 5;
+            _flags = pgm_read_byte(&SECTOR_FLAGS[sector]);
+        }
+
+    } else {
+
+        //set flags for x axis
+        int8_t dx = axisDirection(_x, _centreX, _threshold);
+        if (dx > 0) {
+            _flags |= RIGHT;
+        } else if (dx < 0) {
+            _flags |= LEFT;
+        }
+
+        //set flags for y axis (both axes can change at once)
+        int8_t dy = axisDirection(_y, _centreY, _threshold);
+        if (dy < 0) {
+            _flags |= UP;
+        } else if (dy > 0) {
+            _flags |= DOWN;
+        }
 
-    //set flags for x axis
-    if (_x > _centreX + _threshold) {
-        _flags |= RIGHT;
-    } else if (_x < _centreX - _threshold) {
-        _flags |= LEFT;
     }
 
-    //set flags for y axis (both axes can change at once)
-    if (_y < _centreY - _threshold) {
-        _flags |= UP;
-    } else if (_y > _centreY + _threshold) {
-        _flags |= DOWN;
+    //follow centre drift while resting
+    if (_options & TRACK_CENTRE) {
+        _trackCentre();
     }
+    _lastX = _x;
+    _lastY = _y;
 
     //have we changed since last read?
     _changed = _flags != _lastFlags;
@@ -63,10 +153,44 @@ boolean Joystick::read() {
         _lastChange = _time;
     }
 
+    _statsEndRead();
+
     return _changed;
     
 }
 
+/**
+ * Estimate velocity and acceleration of each axis.
+ */
+void Joystick::setMotionEstimators(MotionEstimator *x, MotionEstimator *y) {
+    _motionX = x;
+    _motionY = y;
+    _resetMotion();
+}
+
+/**
+ * Where the x axis will be in ms milliseconds at its current velocity.
+ */
+int Joystick::getPredictedX(unsigned int ms) {
+    return _motionX ? _motionX->predict(ms, _minX, _maxX) : _x;
+}
+
+/**
+ * Where the y axis will be in ms milliseconds at its current velocity.
+ */
+int Joystick::getPredictedY(unsigned int ms) {
+    return _motionY ? _motionY->predict(ms, _minY, _maxY) : _y;
+}
+
+/**
+ * Start the motion estimators from the current position.
+ */
+void Joystick::_resetMotion() {
+    uint32_t us = Clock::nowMicros();
+    if (_motionX) _motionX->reset(_x, us);
+    if (_motionY) _motionY->reset(_y, us);
+}
+
 /**
  * Returns the current x value.
  */ 
@@ -95,6 +219,209 @@ int Joystick::getDeltaY() {
     return _y - _centreY; 
 }
 
+/**
+ * Measure the noise on both axes at rest, re-centre, and set the 
+ * smallest threshold that covers the noise.
+ */
+NoiseProfile Joystick::calibrateNoise(unsigned int samples, int margin) {
+
+    NoiseMeter meterX, meterY;
+    samples = constrain(samples, 1, NoiseMeter::MAX_SAMPLES);
+
+    for (unsigned int i=0; i<samples; i++) {
+        _readPins();
+        meterX.add(_x);
+        meterY.add(_y);
+    }
+
+    NoiseProfile x = meterX.result();
+    NoiseProfile y = meterY.result();
+
+    setCalibrationX(_minX, x.mean, _maxX);
+    setCalibrationY(_minY, y.mean, _maxY);
+
+    //furthest any sample got from the centre
+    int reach = max(max(x.max - x.mean, x.mean - x.min), max(y.max - y.mean, y.mean - y.min));
+    _threshold = reach + margin;
+    _restBand = min(max(x.peakToPeak, y.peakToPeak), (uint16_t)255);
+
+    _flags = 0;
+    _lastFlags = 0;
+    _changed = false;
+
+    return x.peakToPeak >= y.peakToPeak ? x : y;
+
+}
+
+/**
+ * Slowly re-learn the centre while the stick is resting inside the dead zone.
+ */
+void Joystick::setCentreTracking(boolean track, byte restBand, byte maxRate) {
+    _setOption(TRACK_CENTRE, track);
+    _restBand = restBand;
+    _maxDriftRate = maxRate;
+    _driftTime = _time;
+}
+
+/**
+ * Supply calibration for the x axis.
+ */
+void Joystick::setCalibrationX(int min, int centre, int max) {
+    _minX = min;
+    _centreX = centre;
+    _centreQ4X = centre << 4;
+    _maxX = max;
+    _options |= CALIBRATED;
+}
+
+/**
+ * Supply calibration for the y axis.
+ */
+void Joystick::setCalibrationY(int min, int centre, int max) {
+    _minY = min;
+    _centreY = centre;
+    _centreQ4Y = centre << 4;
+    _maxY = max;
+    _options |= CALIBRATED;
+}
+
+/**
+ * Move the centre estimate towards the current position while resting
+ * inside the dead zone. The centre is kept in 1/16ths of a raw unit, and
+ * the time since the last step is accumulated until it allows at least
+ * one 1/16th, so the drift rate holds at any loop speed.
+ */
+void Joystick::_trackCentre() {
+
+    boolean resting = !_flags
+        && abs(_x - _lastX) <= _restBand
+        && abs(_y - _lastY) <= _restBand;
+
+    if (!resting) {
+        _driftTime = _time;
+        return;
+    }
+
+    uint16_t elapsed = (uint16_t)_time - _driftTime;
+    int step = ((uint32_t)_maxDriftRate * elapsed * 16) / 1000;
+    if (step == 0) {
+        return;
+    }
+    _driftTime = _time;
+
+    _centreQ4X = _slew(_centreQ4X, _x, step);
+    _centreQ4Y = _slew(_centreQ4Y, _y, step);
+    _centreX = (_centreQ4X + 8) >> 4;
+    _centreY = (_centreQ4Y + 8) >> 4;
+
+}
+
+/**
+ * Move a centre towards a position by at most step (all in 1/16ths).
+ */
+int Joystick::_slew(int centreQ4, int position, int step) {
+    int diff = (position << 4) - centreQ4;
+    return centreQ4 + constrain(diff, -step, step);
+}
+
+/**
+ * Save centre and range of both axes.
+ */
+void Joystick::saveCalibration(CalibrationRecord &record) {
+    record = CalibrationRecord();
+    record.kind = CALIBRATION_KIND;
+    record.values[0] = _minX;
+    record.values[1] = _centreX;
+    record.values[2] = _maxX;
+    record.values[3] = _minY;
+    record.values[4] = _centreY;
+    record.values[5] = _maxY;
+}
+
+/**
+ * Restore centre and range of both axes.
+ */
+void Joystick::loadCalibration(const CalibrationRecord &record) {
+    if (record.kind == CALIBRATION_KIND) {
+        setCalibrationX(record.values[0], record.values[1], record.values[2]);
+        setCalibrationY(record.values[3], record.values[4], record.values[5]);
+    }
+}
+
+/**
+ * Calibrated distance from the centre, from -NORMALIZED_MAX to NORMALIZED_MAX.
+ */
+int Joystick::getNormalizedX() {
+    return _normalize(_x, _minX, _centreX, _maxX);
+}
+
+/**
+ * Calibrated distance from the centre, from -NORMALIZED_MAX to NORMALIZED_MAX.
+ */
+int Joystick::getNormalizedY() {
+    return _normalize(_y, _minY, _centreY, _maxY);
+}
+
+/**
+ * Angle of the stick from the centre as a binary angle.
+ */
+byte Joystick::getAngle() {
+    return _angleOf(_x - _centreX, _y - _centreY);
+}
+
+/**
+ * Quantize the stick angle into a number of equal sectors.
+ */
+byte Joystick::getDirection(byte sectors) {
+    if (!_flags || !sectors) {
+        return NO_DIRECTION;
+    }
+    return (((unsigned int)getAngle() * sectors + 128) >> 8) % sectors;
+}
+
+/**
+ * Binary angle of a delta from the centre, using an atan lookup table
+ * for the first octant and folding the other octants onto it.
+ */
+byte Joystick::_angleOf(int dx, int dy) {
+
+    int ax = dx < 0 ? -dx : dx;
+    int ay = dy > 0 ? dy : -dy;
+    byte angle;
+
+    if (ax == 0 && ay == 0) {
+        return 0;
+    } else if (ax >= ay) {
+        angle = pgm_read_byte(&ATAN_TABLE[((long)ay << 5) / ax]);
+    } else {
+        angle = 64 - pgm_read_byte(&ATAN_TABLE[((long)ax << 5) / ay]);
+    }
+
+    //fold into the right quadrant
+    if (dx < 0) angle = 128 - angle;
+    if (dy > 0) angle = -angle;
+
+    return angle;
+
+}
+
+/**
+ * Scale a delta from the centre to +/- NORMALIZED_MAX,
+ * scaling each side of the centre separately.
+ */
+int Joystick::_normalize(int value, int min, int centre, int max) {
+
+    long delta = value - centre;
+    int span = delta >= 0 ? max - centre : centre - min;
+    if (span <= 0) {
+        return 0;
+    }
+
+    delta = delta * NORMALIZED_MAX / span;
+    return constrain(delta, -NORMALIZED_MAX, NORMALIZED_MAX);
+
+}
+
 /**
  * Whether the joystick is currently moving left.
  */ 
@@ -154,27 +481,27 @@ boolean Joystick::movedDown() {
 /**
  * Whether the joystick has been moving left for ms milliseconds.
  */
-boolean Joystick::heldLeftFor(int ms) { 
+boolean Joystick::heldLeftFor(uint32_t ms) { 
     return movingLeft() && _time - _lastChange > ms; 
 }
 
 /**
  * Whether the joystick has been moving right for ms milliseconds.
  */
-boolean Joystick::heldRightFor(int ms) { 
+boolean Joystick::heldRightFor(uint32_t ms) { 
     return movingRight() && _time - _lastChange > ms; 
 }
 
 /**
  * Whether the joystick has been moving up for ms milliseconds.
  */
-boolean Joystick::heldUpFor(int ms) { 
+boolean Joystick::heldUpFor(uint32_t ms) { 
     return movingUp() && _time - _lastChange > ms; 
 }
 
 /**
  * Whether the joystick has been moving down for ms milliseconds.
  */
-boolean Joystick::heldDownFor(int ms)  { 
+boolean Joystick::heldDownFor(uint32_t ms)  { 
     return movingDown() && _time - _lastChange > ms; 
 }
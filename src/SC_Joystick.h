@@ -2,6 +2,8 @@
 
 #include "Arduino.h"
 #include "SC_Control.h"
+#include "SC_Noise.h"
+#include "SC_Motion.h"
 
 /**
  * Joystick class to simplify reading a joystick.
@@ -16,18 +18,53 @@
  */
 class Joystick : public Control {
 
-  const int  DEFAULT_THRESHOLD  = 150;
-  const byte LEFT               = 1<<0;
-  const byte RIGHT              = 1<<1;
-  const byte UP                 = 1<<2;
-  const byte DOWN               = 1<<3;
-
   public:
 
+    static constexpr int  DEFAULT_THRESHOLD  = 150;
+    static constexpr byte LEFT               = 1<<0;
+    static constexpr byte RIGHT              = 1<<1;
+    static constexpr byte UP                 = 1<<2;
+    static constexpr byte DOWN               = 1<<3;
+
+    /**
+     * Maximum raw value of an axis.
+     */
+    static constexpr int  ADC_MAX            = 1023;
+
+    /**
+     * Full deflection for normalized output (fixed point, 1024 = 1.0).
+     */
+    static constexpr int  NORMALIZED_MAX     = 1024;
+
+    /**
+     * Per-instance RAM allowed on top of the Control base, checked at compile
+     * time. The members take 47 bytes on AVR; hosts and 32 bit boards pad
+     * them out to 80.
+     */
+#if defined(__AVR__)
+    static constexpr size_t RAM_BUDGET       = sizeof(Control) + 50;
+#else
+    static constexpr size_t RAM_BUDGET       = sizeof(Control) + 88;
+#endif
+
+    /**
+     * Returned by getDirection() while inside the dead zone.
+     */
+    static constexpr byte NO_DIRECTION       = 255;
+
+    /**
+     * Which side of the dead zone a single axis is on.
+     * 
+     * @return int8_t 1 if above centre + threshold, -1 if below centre - threshold, otherwise 0.
+     */
+    static inline int8_t axisDirection(int value, int centre, int threshold) {
+      return value > centre + threshold ? 1 : (value < centre - threshold ? -1 : 0);
+    }
+
     /**
      * Supply pins for x and y axis.
      */
-    Joystick(byte pinX, byte pinY, int threshold = 150) : 
+    Joystick(byte pinX, byte pinY, int threshold = DEFAULT_THRESHOLD) : 
       _pinX(pinX), _pinY(pinY), _threshold(threshold) {}
 
     /**
@@ -111,30 +148,175 @@ class Joystick : public Control {
     /**
      * Whether the joystick has been moving left for ms milliseconds.
      * 
-     * @param int milliseconds to consider.
+     * @param uint32_t milliseconds to consider.
      */
-    boolean heldLeftFor(int ms);
+    boolean heldLeftFor(uint32_t ms);
     
     /**
      * Whether the joystick has been moving right for ms milliseconds.
      * 
-     * @param int milliseconds to consider.
+     * @param uint32_t milliseconds to consider.
      */
-    boolean heldRightFor(int ms);
+    boolean heldRightFor(uint32_t ms);
     
     /**
      * Whether the joystick has been moving up for ms milliseconds.
      * 
-     * @param int milliseconds to consider.
+     * @param uint32_t milliseconds to consider.
      */
-    boolean heldUpFor(int ms);
+    boolean heldUpFor(uint32_t ms);
     
     /**
      * Whether the joystick has been moving down for ms milliseconds.
      * 
-     * @param int milliseconds to consider.
+     * @param uint32_t milliseconds to consider.
+     */
+    boolean heldDownFor(uint32_t ms);
+
+    /**
+     * Use a circular dead zone of radius threshold around the centre, instead
+     * of checking each axis separately (a square dead zone).
+     * 
+     * Direction flags then come from the angle of the stick, so diagonals
+     * only fire when the stick is actually pushed diagonally (8-way).
+     */
+    inline void setRadialDeadZone(boolean radial) { _setOption(RADIAL, radial); }
+
+    /**
+     * Whether the dead zone is circular.
+     */
+    inline boolean isRadialDeadZone() { return _options & RADIAL; }
+
+    /**
+     * Expand the calibrated min/max of each axis whenever the stick goes past it.
+     * 
+     * Call before begin(), then move the stick around its full range to learn it.
+     * Without a calibration, begin() starts the range at the centre it reads. 
+     * A calibration set or loaded before begin() is widened from where it is.
+     */
+    inline void setRangeLearning(boolean learn) { _setOption(LEARN_RANGE, learn); }
+
+    /**
+     * Current dead zone threshold, ie after calibrateNoise().
+     */
+    inline int getThreshold() { return _threshold; }
+
+    /**
+     * Set the dead zone threshold.
+     */
+    inline void setThreshold(int threshold) { _threshold = threshold; }
+
+    /**
+     * Movement between reads that still counts as resting for centre tracking.
+     */
+    inline byte getRestBand() { return _restBand; }
+
+    /**
+     * Measure the noise on both axes with the stick at rest, then re-centre and 
+     * set the smallest threshold (and rest band) that will not report movement.
+     * The stick must not be touched. Call after begin().
+     * 
+     * @param unsigned int samples Number of reads, up to NoiseMeter::MAX_SAMPLES.
+     * @param int margin (Optional) Extra raw units to add to the threshold. Default is 2.
+     * @return NoiseProfile The noise of the noisier axis.
+     */
+    NoiseProfile calibrateNoise(unsigned int samples = 256, int margin = 2);
+
+    /**
+     * Estimate velocity and acceleration of each axis on every read().
+     * 
+     * The estimators must stay in scope as long as the joystick is used. 
+     * Supply nullptr to stop (either axis can be left out).
+     */
+    void setMotionEstimators(MotionEstimator *x, MotionEstimator *y);
+
+    /**
+     * Where each axis will be in ms milliseconds at its current velocity,
+     * clamped to the calibrated range. Needs a MotionEstimator for the axis.
+     */
+    int getPredictedX(unsigned int ms);
+    int getPredictedY(unsigned int ms);
+
+    /**
+     * Slowly re-learn the centre while the stick is resting inside the dead zone,
+     * to follow temperature drift or a stick that was touched during begin().
+     * 
+     * The centre only moves while every axis has moved by no more than restBand
+     * since the last read, and by no more than maxRate raw units per second.
+     * This allows a much smaller threshold without false events.
+     * 
+     * @param boolean track Whether to track the centre.
+     * @param byte restBand (Optional) Largest movement between reads that counts as resting. Default is 2.
+     * @param byte maxRate (Optional) Fastest drift in raw units per second. Default is 8.
+     */
+    void setCentreTracking(boolean track, byte restBand = 2, byte maxRate = 8);
+
+    /**
+     * Supply calibration for the x axis.
+     */
+    void setCalibrationX(int min, int centre, int max);
+
+    /**
+     * Supply calibration for the y axis.
+     */
+    void setCalibrationY(int min, int centre, int max);
+
+    /**
+     * Save centre and range of both axes.
+     */
+    virtual void saveCalibration(CalibrationRecord &record);
+
+    /**
+     * Restore centre and range of both axes, so begin() does not
+     * need the stick to be centred.
+     */
+    virtual void loadCalibration(const CalibrationRecord &record);
+
+    /**
+     * Record kind saved by joysticks.
+     */
+    static constexpr byte CALIBRATION_KIND = 'J';
+
+    /**
+     * Calibrated centre of each axis. Follows the current estimate if tracking.
+     */
+    inline int getCentreX() { return _centreX; }
+    inline int getCentreY() { return _centreY; }
+
+    /**
+     * Calibrated range of each axis.
+     */
+    inline int getMinX() { return _minX; }
+    inline int getMaxX() { return _maxX; }
+    inline int getMinY() { return _minY; }
+    inline int getMaxY() { return _maxY; }
+
+    /**
+     * Calibrated distance from the centre, from -NORMALIZED_MAX to NORMALIZED_MAX.
+     * 
+     * Each side of the centre is scaled separately, so an off-centre stick still
+     * reaches full deflection in both directions.
+     */
+    int getNormalizedX();
+
+    /**
+     * Calibrated distance from the centre, from -NORMALIZED_MAX to NORMALIZED_MAX.
+     */
+    int getNormalizedY();
+
+    /**
+     * Angle of the stick from the centre as a binary angle (0-255 for a full circle),
+     * with 0 to the right and 64 up, increasing anti-clockwise.
+     */
+    byte getAngle();
+
+    /**
+     * Quantize the stick angle into a number of equal sectors, with sector 0
+     * centred on the right and counting anti-clockwise (ie 4 for 4-way, 8 for 8-way).
+     * 
+     * @return byte The sector, or NO_DIRECTION if inside the dead zone.
      */
-    boolean heldDownFor(int ms);
+    byte getDirection(byte sectors = 8);
 
     /**
      * Whether the value has changed since the last read.
@@ -142,24 +324,68 @@ class Joystick : public Control {
     inline boolean changed() { return _changed; }
 
     /**
-     * Time since last change in millis.
+     * Time of last change in millis (from Clock::now()).
      */
-    inline int lastChange() { return _lastChange; }
+    inline uint32_t lastChange() { return _lastChange; }
   
   protected:
     byte _pinX;
     byte _pinY;
     int _threshold;
     int _x, _y, _centreX, _centreY;
+    int _minX = 0, _maxX = ADC_MAX, _minY = 0, _maxY = ADC_MAX;
     byte _lastFlags = 0, _flags = 0;
-    int _time = 0, _lastChange = 0;
+    byte _options = 0;
+    int _lastX = 0, _lastY = 0;
+    int _centreQ4X = 0, _centreQ4Y = 0;
+    uint16_t _driftTime = 0;
+    byte _restBand = 2, _maxDriftRate = 8;
+    MotionEstimator *_motionX = nullptr, *_motionY = nullptr;
+
+    static constexpr byte RADIAL      = 1<<0;
+    static constexpr byte LEARN_RANGE = 1<<1;
+    static constexpr byte CALIBRATED  = 1<<2;
+    static constexpr byte TRACK_CENTRE = 1<<3;
+
+    /**
+     * Start the motion estimators from the current position.
+     */
+    void _resetMotion();
+
+    /**
+     * Move the centre estimate towards the current position, rate limited.
+     */
+    void _trackCentre();
+
+    /**
+     * Move a centre towards a position by at most step (all in 1/16ths).
+     */
+    static int _slew(int centreQ4, int position, int step);
+
+    inline void _setOption(byte option, boolean on) {
+      _options = on ? (_options | option) : (_options & ~option);
+    }
+
+    /**
+     * Binary angle of a delta from the centre, with y pointing down as read.
+     */
+    static byte _angleOf(int dx, int dy);
+
+    /**
+     * Scale a delta from the centre to +/- NORMALIZED_MAX.
+     */
+    static int _normalize(int value, int min, int centre, int max);
+    uint32_t _time = 0, _lastChange = 0;
 
     /**
-     * Read the pins.
+     * Read both axes back-to-back.
      */ 
     virtual void _readPins() {
-      _x = analogRead(_pinX);
-      _y = analogRead(_pinY);
+      const byte pins[] = { _pinX, _pinY };
+      int values[2];
+      _readBurst(2, pins, nullptr, nullptr, nullptr, values);
+      _x = values[0];
+      _y = values[1];
     }
 
 };
@@ -0,0 +1,58 @@
+#include "SC_Motion.h"
+
+constexpr uint16_t MotionEstimator::MIN_INTERVAL;
+constexpr long MotionEstimator::MAX_VELOCITY;
+
+/**
+ * Start again from a value at rest.
+ */
+void MotionEstimator::reset(int value, uint32_t micros) {
+    _value = value;
+    _current = value;
+    _time = micros;
+    _velocity = 0;
+    _acceleration = 0;
+}
+
+/**
+ * Add a new value. Velocity is kept in 1/16 units per second.
+ */
+void MotionEstimator::update(int value, uint32_t micros) {
+
+    _current = value;
+    uint32_t dt = micros - _time;
+    if (dt < MIN_INTERVAL) {
+        return;
+    } else if (dt > 1000000L) {
+        //too long ago to tell how we got here
+        reset(value, micros);
+        return;
+    }
+
+    //velocity since the last update, in units per second
+    long d = constrain(value - _value, -2047, 2047);
+    long v = d * 1000000L / (long)dt;
+    v = constrain(v, -MAX_VELOCITY, MAX_VELOCITY);
+
+    long last = _velocity;
+    _velocity += ((v << 4) - _velocity) >> _smoothing;
+
+    //change in smoothed velocity, split to stay within 32 bits
+    long dv = (_velocity - last) >> 4;
+    long a = dv * 2000L / (long)dt * 500L;
+    _acceleration += (a - _acceleration) >> _smoothing;
+
+    _value = value;
+    _time = micros;
+
+}
+
+/**
+ * Where the value will be in ms milliseconds at the current velocity.
+ */
+int MotionEstimator::predict(unsigned int ms, int min, int max) {
+    //split so a long look ahead cannot overflow
+    long v = getVelocity();
+    long predicted = _current + (v / 1000) * (long)ms + (v % 1000) * (long)ms / 1000;
+    return constrain(predicted, (long)min, (long)max);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Estimates the velocity and acceleration of a control from its 
+ * timestamped values, and predicts where it will be a little ahead.
+ * 
+ * Smoothing adds lag. Extrapolating along the current velocity wins
+ * some of it back for fast movements, while the control stays smooth 
+ * at rest (where the velocity decays to 0).
+ * 
+ * Everything is integer maths, updated incrementally. Updates less 
+ * than MIN_INTERVAL apart are skipped, so a fast loop does not turn 
+ * single unit steps into huge velocities. Estimates are smoothed with 
+ * an exponential moving average of alpha 1 / 2^smoothing.
+ * 
+ * Attach to a Potentiometer with setMotionEstimator(), or to each axis 
+ * of a Joystick with setMotionEstimators().
+ */
+class MotionEstimator {
+
+  public:
+
+    /**
+     * Shortest time between updates in microseconds.
+     */
+    static constexpr uint16_t MIN_INTERVAL = 1000;
+
+    /**
+     * Fastest velocity tracked, in units per second.
+     */
+    static constexpr long MAX_VELOCITY = 500000L;
+
+    /**
+     * @param byte smoothing (Optional) Smoothing shift, 0 for none. Default is 3.
+     */
+    MotionEstimator(byte smoothing = 3) : _smoothing(smoothing) {}
+
+    /**
+     * Start again from a value at rest.
+     * 
+     * @param int value The current value.
+     * @param uint32_t micros Time of the value, ie from Clock::nowMicros().
+     */
+    void reset(int value, uint32_t micros);
+
+    /**
+     * Add a new value.
+     * 
+     * @param int value The current (filtered) value.
+     * @param uint32_t micros Time of the value, ie from Clock::nowMicros().
+     */
+    void update(int value, uint32_t micros);
+
+    /**
+     * Current velocity in units per second.
+     */
+    inline long getVelocity() { return _velocity >> 4; }
+
+    /**
+     * Current acceleration in units per second per second.
+     */
+    inline long getAcceleration() { return _acceleration; }
+
+    /**
+     * Where the value will be in ms milliseconds at the current velocity,
+     * clamped to a range.
+     * 
+     * Only the velocity is used. The acceleration is much noisier, and 
+     * extrapolating with it overshoots at the end of every movement.
+     */
+    int predict(unsigned int ms, int min, int max);
+
+  protected:
+    byte _smoothing;
+    int _value = 0, _current = 0;
+    uint32_t _time = 0;
+    long _velocity = 0, _acceleration = 0;
+
+};
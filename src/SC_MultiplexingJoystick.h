@@ -13,7 +13,7 @@ class MultiplexingJoystick : public Joystick {
         /**
          * Mux version.
          */ 
-        MultiplexingJoystick(byte signalPin, Multiplexer *mux, byte muxChannelX, byte muxChannelY, int threshold = 150) : 
+        MultiplexingJoystick(byte signalPin, Multiplexer *mux, byte muxChannelX, byte muxChannelY, int threshold = DEFAULT_THRESHOLD) : 
             Joystick(0, 0, threshold), _channelX(muxChannelX), _channelY(muxChannelY) {        
                 _pinX = signalPin; //use x as the sig pin
                 setMultiplexer(mux, 0); //mux channel will be set for each axis at read time
@@ -23,16 +23,15 @@ class MultiplexingJoystick : public Joystick {
         byte _channelX, _channelY;
 
         /**
-         * Switch mux channel before reading each pin.
+         * Read both axes back-to-back, switching mux channel before each.
          */ 
         void _readPins() override {
-            
-            _muxChannel = _channelX;
-            _x = analogRead(_pinX);
-
-            _muxChannel = _channelY;
-            _y = analogRead(_pinX);
-
+            const byte pins[] = { _pinX, _pinX };
+            const byte channels[] = { _channelX, _channelY };
+            int values[2];
+            _readBurst(2, pins, channels, nullptr, nullptr, values);
+            _x = values[0];
+            _y = values[1];
         }
 
 };
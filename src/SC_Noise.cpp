@@ -0,0 +1,7 @@
+/**
+ * Accumulates samples into a NoiseProfile using integer maths.
+ */
+
+#include "SC_Noise.h"
+
+constexpr unsigned int NoiseMeter::MAX_SAMPLES;
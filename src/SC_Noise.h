@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Noise measured on a control at rest.
+ */
+struct NoiseProfile {
+  int min;              // lowest value seen
+  int max;              // highest value seen
+  int mean;             // average value
+  uint16_t peakToPeak;  // max - min
+  uint16_t variance;    // in raw units squared
+};
+
+/**
+ * Accumulates samples into a NoiseProfile using integer maths.
+ * 
+ * Sums are kept relative to the first sample so they cannot
+ * overflow for up to MAX_SAMPLES samples.
+ */
+class NoiseMeter {
+
+  public:
+
+    static constexpr unsigned int MAX_SAMPLES = 1024;
+
+    /**
+     * Add a sample.
+     */
+    void add(int value) {
+      if (_count == 0) {
+        _first = value;
+        _min = value;
+        _max = value;
+      }
+      if (value < _min) _min = value;
+      if (value > _max) _max = value;
+      long d = value - _first;
+      _sum += d;
+      _sumSquares += d * d;
+      _count++;
+    }
+
+    /**
+     * The profile of every sample added so far.
+     */
+    NoiseProfile result() {
+      NoiseProfile profile;
+      long mean = _count ? _sum / (long)_count : 0;
+      uint32_t variance = _count ? _sumSquares / _count - mean * mean : 0;
+      profile.min = _min;
+      profile.max = _max;
+      profile.mean = _first + mean;
+      profile.peakToPeak = _max - _min;
+      profile.variance = variance > 0xFFFF ? 0xFFFF : variance;
+      return profile;
+    }
+
+  protected:
+    int _first = 0, _min = 0, _max = 0;
+    long _sum = 0;
+    uint32_t _sumSquares = 0;
+    unsigned int _count = 0;
+
+};
@@ -0,0 +1,43 @@
+/**
+ * Rate-limited, coalescing output for control changes.
+ */
+
+#include "SC_Output.h"
+
+constexpr byte ControlOutputBase::MAX_MESSAGE;
+
+/**
+ * Encode the slot's current value, clamped to the range of the format.
+ */
+byte ControlOutputBase::_encode(const Slot &slot, byte *buffer) {
+
+    int value = slot.value < 0 ? 0 : slot.value;
+
+    switch (slot.format) {
+
+        case MIDI_CC:
+            buffer[0] = 0xB0 | (slot.channel & 0x0F);
+            buffer[1] = slot.id & 0x7F;
+            buffer[2] = value > 127 ? 127 : value;
+            return 3;
+
+        case MIDI_CC_14:
+            if (value > 16383) value = 16383;
+            buffer[0] = 0xB0 | (slot.channel & 0x0F);
+            buffer[1] = slot.id & 0x1F;
+            buffer[2] = value >> 7;
+            buffer[3] = buffer[0];
+            buffer[4] = (slot.id & 0x1F) + 32;
+            buffer[5] = value & 0x7F;
+            return 6;
+
+        default:
+            if (value > 16383) value = 16383;
+            buffer[0] = 0x80 | (slot.id & 0x7F);
+            buffer[1] = value >> 7;
+            buffer[2] = value & 0x7F;
+            return 3;
+
+    }
+
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Button.h"
+#include "SC_Joystick.h"
+#include "SC_Potentiometer.h"
+
+/**
+ * Non-template part of ControlOutput: slot layout and message encoding.
+ */
+class ControlOutputBase {
+
+  public:
+
+    /**
+     * Message formats.
+     *
+     * MIDI_CC      3 byte Control Change, value 0-127.
+     * MIDI_CC_14   Two Control Changes (id and id+32), value 0-16383. Id must be 0-31.
+     * FRAME        3 byte binary frame: [0x80 | id][value bits 13-7][value bits 6-0],
+     *              value 0-16383, id 0-127. Only the first byte has the top bit set,
+     *              so a receiver can resync on any byte.
+     */
+    enum Format : byte { MIDI_CC, MIDI_CC_14, FRAME };
+
+    /**
+     * Longest encoded message.
+     */
+    static constexpr byte MAX_MESSAGE = 6;
+
+  protected:
+
+    struct Slot {
+      uint32_t lastSent;
+      unsigned int interval;
+      int value;
+      int sentValue;
+      byte format;
+      byte id;
+      byte channel;
+      boolean dirty;
+    };
+
+    /**
+     * Encode the slot's current value.
+     *
+     * @return byte Number of bytes written to buffer.
+     */
+    static byte _encode(const Slot &slot, byte *buffer);
+
+    /**
+     * Largest value a format can send.
+     */
+    static inline int _formatMax(byte format) { return format == MIDI_CC ? 127 : 16383; }
+
+};
+
+/**
+ * Rate-limited, coalescing output for control changes.
+ *
+ * Each slot has a minimum interval between messages. Values set more often
+ * than that are coalesced, so only the latest value is sent when the interval
+ * expires. Messages are only written when the output has room for the whole
+ * message, so update() never blocks on a full TX buffer.
+ *
+ * The output must report availableForWrite() (HardwareSerial does). Streams
+ * that always report 0 will never be written to.
+ *
+ * Usage:
+ *
+ *   ControlOutput<2> output(Serial);
+ *   byte volume = output.add(ControlOutputBase::MIDI_CC, 7, 0, 10);
+ *   byte mute = output.add(ControlOutputBase::MIDI_CC, 9);
+ *   ...
+ *   void loop() {
+ *     pot.read();
+ *     button.read();
+ *     output.set(volume, pot);
+ *     output.set(mute, button);
+ *     output.update();
+ *   }
+ */
+template<byte N>
+class ControlOutput : public ControlOutputBase {
+
+  public:
+
+    ControlOutput(Print &out) : _out(out) {}
+
+    /**
+     * Add an output slot.
+     *
+     * @param Format format Message format.
+     * @param byte id CC number, or frame id.
+     * @param byte channel (Optional) MIDI channel 0-15. Ignored for frames.
+     * @param unsigned int interval (Optional) Minimum milliseconds between messages. Default is 10.
+     * @return byte Slot index, or 255 if full.
+     */
+    byte add(Format format, byte id, byte channel = 0, unsigned int interval = 10) {
+      if (_count >= N) {
+        return 255;
+      }
+      Slot &slot = _slots[_count];
+      slot.format = format;
+      slot.id = id;
+      slot.channel = channel;
+      slot.interval = interval;
+      slot.lastSent = Clock::now() - interval;
+      slot.value = -1;
+      slot.sentValue = -1;
+      slot.dirty = false;
+      return _count++;
+    }
+
+    /**
+     * Set the latest value for a slot. It will be sent on a later update().
+     */
+    void set(byte index, int value) {
+      if (index >= _count) {
+        return;
+      }
+      Slot &slot = _slots[index];
+      slot.value = value;
+      slot.dirty = value != slot.sentValue;
+    }
+
+    /**
+     * Queue the pot's value if it changed on the last read.
+     *
+     * The value is scaled from the pot's resolution (or the full 0-1023 range
+     * without one) to the full range of the slot's format, so a full turn
+     * always sends 0 to 127 on a MIDI_CC slot.
+     */
+    void set(byte index, Potentiometer &pot) {
+      if (!pot.changed() || index >= _count) {
+        return;
+      }
+      long top = pot.getResolution() > 0 ? pot.getResolution() : Potentiometer::MAX;
+      long max = _formatMax(_slots[index].format);
+      set(index, top == max ? pot.getValue() : (int)((pot.getValue() * max + top / 2) / top));
+    }
+
+    /**
+     * Queue the button state if it changed on the last read.
+     *
+     * Pressed is sent as the maximum value for the format, released as 0.
+     */
+    inline void set(byte index, Button &button) {
+      if (button.changed() && index < _count) {
+        set(index, button.isPressed() ? _formatMax(_slots[index].format) : 0);
+      }
+    }
+
+    /**
+     * Queue the joystick x and y position, scaled to the full range of each
+     * slot's format with the centre in the middle.
+     *
+     * Inside the dead zone an axis sends exactly the centre. The dead zone is
+     * the joystick's own, as of the last read: with a radial dead zone both
+     * axes leave it together, otherwise each axis has its own. Elsewhere, a
+     * value is only queued once the axis has moved by more than the joystick's
+     * rest band, so ADC jitter does not keep the slot busy.
+     */
+    void set(byte indexX, byte indexY, Joystick &joystick) {
+      int band = joystick.getRestBand();
+      boolean movingX = joystick.movingLeft() || joystick.movingRight();
+      boolean movingY = joystick.movingUp() || joystick.movingDown();
+      if (joystick.isRadialDeadZone()) {
+        movingX = movingY = movingX || movingY;
+      }
+      _setAxis(indexX, movingX ? joystick.getNormalizedX() : 0, band);
+      _setAxis(indexY, movingY ? joystick.getNormalizedY() : 0, band);
+    }
+
+    /**
+     * Send every pending slot whose interval has expired.
+     *
+     * Stops at the first message that doesn't fit in the TX buffer and
+     * leaves it pending. This should be called once in the Arduino loop().
+     *
+     * @return byte Number of messages sent.
+     */
+    byte update() {
+
+      byte sent = 0;
+      byte buffer[MAX_MESSAGE];
+      uint32_t ms = Clock::now();
+
+      for (byte i=0; i<_count; i++) {
+
+        Slot &slot = _slots[i];
+        if (!slot.dirty || ms - slot.lastSent < slot.interval) {
+          continue;
+        }
+
+        byte len = _encode(slot, buffer);
+        if (_out.availableForWrite() < len) {
+          break;
+        }
+
+        _out.write(buffer, len);
+        slot.lastSent = ms;
+        slot.sentValue = slot.value;
+        slot.dirty = false;
+        sent++;
+
+      }
+
+      return sent;
+
+    }
+
+    /**
+     * Whether any slot is waiting to be sent.
+     */
+    boolean pending() {
+      for (byte i=0; i<_count; i++) {
+        if (_slots[i].dirty) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+  protected:
+    Print &_out;
+    Slot _slots[N];
+    byte _count = 0;
+
+    /**
+     * Scale a normalized axis to the slot's format and queue it if it
+     * moved by more than band raw units (about 2 normalized units each).
+     */
+    void _setAxis(byte index, int normalized, int band) {
+      if (index >= _count) {
+        return;
+      }
+      const long span = 2L * Joystick::NORMALIZED_MAX;
+      long max = _formatMax(_slots[index].format);
+      int value = (normalized + Joystick::NORMALIZED_MAX) * max / span;
+      int last = _slots[index].value;
+      if (last < 0 || value == max / 2 || abs(value - last) * span > 2 * band * max) {
+        set(index, value);
+      }
+    }
+
+};
@@ -9,17 +9,37 @@
 
 #include "SC_Potentiometer.h"
 
+constexpr int Potentiometer::MAX;
+constexpr size_t Potentiometer::RAM_BUDGET;
+constexpr byte Potentiometer::CALIBRATION_KIND;
+constexpr byte Potentiometer::MAX_WARM_START;
+constexpr byte Potentiometer::WARM_START_BAND;
+
 /**
  * Initialise.
  * 
  * Does an initial read as a starting point, but
  * will not update the changed status.
+ * 
+ * With a warm start, seeds from a burst of reads instead
+ * and suppresses changes until the filter has settled.
  */
 void Potentiometer::begin() { 
-    _value = analogRead(_pin);
+    static_assert(sizeof(Potentiometer) <= RAM_BUDGET, "Potentiometer exceeds its RAM budget");
+    _value = _warmStart > 1 ? _readSeed() : analogRead(_pin);
     _lastValue = _value;
-    _time = millis();
+    _settling = _warmStart > 0;
+    _time = Clock::now();
     _lastChange = _time;    
+    if (_filter) {
+        _filter->reset(_value, Clock::nowMicros());
+    }
+    if (_motion) {
+        _motion->reset(_value, Clock::nowMicros());
+    }
+    for (PotentiometerView *view = _views; view; view = view->_next) {
+        _seedView(*view);
+    }
 }
 
 /**
@@ -30,19 +50,56 @@ void Potentiometer::begin() {
  */
 boolean Potentiometer::read() {
 
+    _statsBeginRead();
+
     //get time of read
-    _time = millis();
+    _time = Clock::now();
 
     //read the pin
     _readPin();
+    if (_motion) {
+        _motion->update(_value, Clock::nowMicros());
+    }
 
     //have we changed since last read?
     _calculateChanged();
+    if (_views) {
+        _updateViews();
+    }
+
+    _statsNoise(_value);
+    _statsEndRead();
 
     return _changed;
     
 }
 
+/**
+ * Publish this pot at another resolution as well.
+ */
+void Potentiometer::addView(PotentiometerView &view) {
+    _seedView(view);
+    view._next = _views;
+    _views = &view;
+}
+
+/**
+ * Estimate velocity and acceleration from the filtered value.
+ */
+void Potentiometer::setMotionEstimator(MotionEstimator *motion) {
+    _motion = motion;
+    if (_motion) {
+        _motion->reset(_value, Clock::nowMicros());
+    }
+}
+
+/**
+ * Where the pot will be in ms milliseconds at its current velocity.
+ */
+int Potentiometer::getPredictedValue(unsigned int ms) {
+    return _applyResolution(_motion ? _motion->predict(ms, 0, MAX) : _value);
+}
+
 /**
  * Set the resolution to remap values to.
  * 
@@ -63,6 +120,16 @@ void Potentiometer::setSmoothingFactor(float smoothingFactor) {
     _smoothingFactor = smoothingFactor;
 }
 
+/**
+ * Smooth over a time constant instead of a fixed factor per read.
+ */
+void Potentiometer::setSmoothingFilter(TimeConstantFilter *filter) {
+    _filter = filter;
+    if (_filter) {
+        _filter->reset(_value, Clock::nowMicros());
+    }
+}
+
 /**
  * Set how many times to read the pin.
  * 
@@ -87,6 +154,130 @@ void Potentiometer::setReadDelay(unsigned int readDelay) {
     _readDelay = readDelay;
 }
 
+/**
+ * Set the raw values the pot actually reaches at each end of its travel.
+ */
+void Potentiometer::setEndStops(int min, int max) {
+    _minRaw = min;
+    _maxRaw = max > min ? max : min + 1;
+}
+
+/**
+ * Ignore changes smaller than this many raw units since the last change.
+ */
+void Potentiometer::setNoiseFloor(byte noiseFloor) {
+    _noiseFloor = noiseFloor;
+}
+
+/**
+ * Save end stops and noise floor.
+ */
+void Potentiometer::saveCalibration(CalibrationRecord &record) {
+    record = CalibrationRecord();
+    record.kind = CALIBRATION_KIND;
+    record.noise = _noiseFloor;
+    record.values[0] = _minRaw;
+    record.values[1] = _maxRaw;
+}
+
+/**
+ * Restore end stops and noise floor.
+ */
+void Potentiometer::loadCalibration(const CalibrationRecord &record) {
+    if (record.kind == CALIBRATION_KIND) {
+        setEndStops(record.values[0], record.values[1]);
+        setNoiseFloor(record.noise);
+    }
+}
+
+/**
+ * Read the pin a number of times and measure the raw noise.
+ */
+NoiseProfile Potentiometer::measureNoise(unsigned int samples) {
+
+    NoiseMeter meter;
+    samples = constrain(samples, 1, NoiseMeter::MAX_SAMPLES);
+
+    for (unsigned int i=0; i<samples; i++) {
+        if (_readDelay > 0) {
+            delayMicroseconds(_readDelay);
+        }
+        meter.add(analogRead(_pin));
+    }
+
+    return meter.result();
+
+}
+
+/**
+ * Pick the cheapest configuration that will not report changes at rest.
+ */
+NoiseProfile Potentiometer::calibrateNoise(unsigned int samples) {
+
+    static const float SMOOTHING[] PROGMEM = { 0, 0.6, 0.3, 0.15 };
+    static const byte CANDIDATES = sizeof(SMOOTHING) / sizeof(SMOOTHING[0]);
+
+    //extra reads and delays only let the ADC settle after another pin was 
+    //read, which can't be seen while reading this pin alone, so they are not 
+    //candidates: use the cheapest, but a mux still needs time to settle
+    _readCount = 1;
+    _filter = nullptr;
+    if (!_mux) {
+        _readDelay = 0;
+    }
+
+    NoiseProfile raw = measureNoise(samples);
+    samples = constrain(samples, 1, NoiseMeter::MAX_SAMPLES);
+
+    int step = _resolution > 0 ? (MAX + 1) / _resolution : 1;
+    uint16_t target = max(step / 2, 2);
+    uint16_t noise = raw.peakToPeak;
+
+    for (byte c=0; c<CANDIDATES; c++) {
+
+        _smoothingFactor = pgm_read_float(&SMOOTHING[c]);
+        _value = raw.mean;
+
+        //let the filter settle, then measure what gets through it
+        NoiseMeter meter;
+        for (unsigned int i=0; i<samples; i++) {
+            _readPin();
+            if (i >= samples / 4) {
+                meter.add(_value);
+            }
+        }
+
+        noise = meter.result().peakToPeak;
+        if (noise <= target) {
+            break;
+        }
+
+    }
+
+    _noiseFloor = min(noise, (uint16_t)255);
+    _lastValue = _value;
+    _settling = false;
+    _changed = false;
+
+    return raw;
+
+}
+
+/**
+ * Seed begin() from a burst of reads.
+ */
+void Potentiometer::setWarmStart(byte samples) {
+    _warmStart = min(samples, MAX_WARM_START);
+}
+
+/**
+ * Apply a response curve before resolution mapping and change detection.
+ */
+void Potentiometer::setResponseCurve(const uint16_t *table, byte points) {
+    _curve = points >= 2 ? table : nullptr;
+    _curvePoints = points;
+}
+
 /**
  * Get the current potentiometer value at the configured resolution.
  */
@@ -107,9 +298,6 @@ int Potentiometer::getRawValue() {
 void Potentiometer::_readPin() {
 
     int raw = 0;
-    
-    //save old value
-    _lastValue = _value;
 
     //read as many times as asked to (may help prevent jitter)
     for (byte i=0; i<_readCount; i++) {
@@ -126,15 +314,52 @@ void Potentiometer::_readPin() {
 
     //smooth the value if requested
     _value = _smoothValue(raw);
+
+    //settled once the filter has caught up with the pin
+    if (_settling && abs(raw - _value) <= max(_noiseFloor, WARM_START_BAND)) {
+        _settling = false;
+    }
         
 }
 
+/**
+ * Read the pin repeatedly and average, ignoring the highest 
+ * and lowest reads, to get a starting value that is close 
+ * to where the filter will settle.
+ */
+int Potentiometer::_readSeed() {
+
+    long sum = 0;
+    int lowest = MAX, highest = 0;
+
+    for (byte i=0; i<_warmStart; i++) {
+        if (_readDelay > 0) {
+            delayMicroseconds(_readDelay);
+        }
+        int raw = analogRead(_pin);
+        sum += raw;
+        if (raw < lowest) lowest = raw;
+        if (raw > highest) highest = raw;
+    }
+
+    if (_warmStart > 2) {
+        return (sum - lowest - highest) / (_warmStart - 2);
+    }
+    return sum / _warmStart;
+
+}
+
 /**
  * Smooth the value based on smoothing strategy and settings.
  */ 
 int Potentiometer::_smoothValue(const int raw) {
 
-    if (_smoothingFactor <= 0) {
+    if (_filter) {
+
+        //time constant configured
+        return _filter->update(raw, Clock::nowMicros());
+
+    } else if (_smoothingFactor <= 0) {
 
         //no smoothing configured
         return raw; 
@@ -156,12 +381,24 @@ int Potentiometer::_smoothValue(const int raw) {
 
 /**
  * Calculate whether to set _changed based on resolution.
+ * 
+ * Compares against the value at the last change, so that
+ * movement within the noise floor never adds up to a change.
  */
 void Potentiometer::_calculateChanged() {
 
+    //follow the filter silently until it has settled
+    if (_settling) {
+        _changed = false;
+        _lastValue = _value;
+        return;
+    }
+
     //compare values at the desired resolution
-    _changed = _applyResolution(_value) != _applyResolution(_lastValue);
+    _changed = _applyResolution(_value) != _applyResolution(_lastValue)
+        && abs(_value - _lastValue) > _noiseFloor;
     if (_changed) {
+        _lastValue = _value;
         _lastChange = _time;
     }
 
@@ -171,9 +408,84 @@ void Potentiometer::_calculateChanged() {
  * Change value to configured resolution.
  */
 int Potentiometer::_applyResolution(int raw) {
-    if (_resolution > 0) {
-        return map(raw, 0, MAX, 0, _resolution);
+    return _scale(_applyShape(raw), _resolution);
+}
+
+/**
+ * Apply end stops and response curve, giving a value from 0 to MAX.
+ */
+int Potentiometer::_applyShape(int raw) {
+    if (_minRaw != 0 || _maxRaw != MAX) {
+        raw = constrain(map(raw, _minRaw, _maxRaw, 0, MAX), 0, MAX);
+    }
+    if (_curve) {
+        raw = _applyCurve(raw);
+    }
+    return raw;
+}
+
+/**
+ * Remap a shaped value to a resolution.
+ */
+int Potentiometer::_scale(int shaped, int resolution) {
+    if (resolution > 0) {
+        return map(shaped, 0, MAX, 0, resolution);
     } else {
-        return raw;
+        return shaped;
+    }
+}
+
+/**
+ * Update every view from the current value, shaping it only once.
+ * Views follow silently while the pot is settling after a warm start.
+ */
+void Potentiometer::_updateViews() {
+
+    int shaped = _applyShape(_value);
+
+    for (PotentiometerView *view = _views; view; view = view->_next) {
+        int value = _scale(shaped, view->_resolution);
+        view->_changed = !_settling && value != view->_value 
+            && abs(_value - view->_lastRaw) > view->_hysteresis;
+        if (view->_changed || _settling) {
+            view->_value = value;
+            view->_lastRaw = _value;
+        }
     }
+
+}
+
+/**
+ * Start a view from the current value without reporting a change.
+ */
+void Potentiometer::_seedView(PotentiometerView &view) {
+    view._value = _scale(_applyShape(_value), view._resolution);
+    view._lastRaw = _value;
+    view._changed = false;
+}
+
+/**
+ * Look up a value on the response curve, interpolating
+ * between the two nearest points. Positions are in 1/1024ths
+ * of a segment so the lookup needs no division: raw * 1025 / 1024 
+ * (rounded) stands in for raw * 1024 / MAX, so full travel lands 
+ * exactly on the last point instead of 1/1024th short of it.
+ */
+int Potentiometer::_applyCurve(int raw) {
+
+    byte last = _curvePoints - 1;
+    if (raw <= 0) {
+        return pgm_read_word(&_curve[0]);
+    } else if (raw >= MAX) {
+        return pgm_read_word(&_curve[last]);
+    }
+
+    uint32_t pos = ((uint32_t)raw * last * 1025 + 512) >> 10;
+    byte i = pos >> 10;
+    int frac = pos & 0x3FF;
+    int a = pgm_read_word(&_curve[i]);
+    int b = pgm_read_word(&_curve[i + 1]);
+
+    return a + (((long)(b - a) * frac + 512) >> 10);
+
 }
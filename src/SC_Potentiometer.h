@@ -2,6 +2,52 @@
 
 #include "Arduino.h"
 #include "SC_Control.h"
+#include "SC_Curves.h"
+#include "SC_Noise.h"
+#include "SC_Motion.h"
+#include "SC_TimeFilter.h"
+
+/**
+ * An extra resolution to publish a Potentiometer at, ie 7 bit for MIDI CC,
+ * 14 bit for NRPN and 0-100 for a display, all from the same read.
+ * 
+ * Each view has its own change flag and hysteresis, and is updated once
+ * per Potentiometer::read() from the pot's single filtered value.
+ */
+class PotentiometerView {
+
+  public:
+
+    /**
+     * @param int resolution The resolution to remap values to, ie 128. Supply 0 for the full range.
+     * @param byte hysteresis (Optional) Ignore changes of this many raw units or less since the last change. Default is 0.
+     */
+    PotentiometerView(int resolution, byte hysteresis = 0) : 
+      _resolution(resolution), _hysteresis(hysteresis) {}
+
+    /**
+     * Current value at this view's resolution.
+     */
+    inline int getValue() { return _value; }
+
+    /**
+     * Whether this view's value changed on the last read.
+     */
+    inline boolean changed() { return _changed; }
+
+    inline int getResolution() { return _resolution; }
+
+  protected:
+    friend class Potentiometer;
+
+    int _resolution;
+    byte _hysteresis;
+    boolean _changed = false;
+    int _value = 0;
+    int _lastRaw = 0;
+    PotentiometerView *_next = nullptr;
+
+};
 
 /**
  * Class to provide smooth, easy reading of a potentiometer.
@@ -14,13 +60,24 @@
  */
 class Potentiometer : public Control {
 
-  /**
-   * Maxiumum value of the potentiometer.
-   */
-  const int MAX = 1023;
-
   public:
 
+    /**
+     * Maxiumum value of the potentiometer.
+     */
+    static constexpr int MAX = 1023;
+
+    /**
+     * Per-instance RAM allowed on top of the Control base, checked at compile
+     * time. The members take 38 bytes on AVR; hosts and 32 bit boards pad
+     * them out to 80.
+     */
+#if defined(__AVR__)
+    static constexpr size_t RAM_BUDGET = sizeof(Control) + 40;
+#else
+    static constexpr size_t RAM_BUDGET = sizeof(Control) + 88;
+#endif
+
     /**
      * Create a new potentiometer object.
      * 
@@ -69,6 +126,15 @@ class Potentiometer : public Control {
      */ 
     void setSmoothingFactor(float smoothingFactor);
 
+    /**
+     * Smooth over a time constant instead of a fixed factor per read,
+     * so the pot responds in the same time however often read() is called.
+     * 
+     * The filter must stay in scope as long as the pot is used. Replaces the 
+     * smoothing factor until set back to nullptr or calibrateNoise() is called.
+     */
+    void setSmoothingFilter(TimeConstantFilter *filter);
+
     /**
      * Set how many times to read the pin.
      * 
@@ -89,6 +155,137 @@ class Potentiometer : public Control {
      */ 
     void setReadDelay(unsigned int readDelay);
 
+    /**
+     * Publish this pot at another resolution as well.
+     * 
+     * The view is updated on every read(), from the same filtered value. 
+     * The view must stay in scope as long as the pot is used. Views added 
+     * before begin() read 0 until begin() seeds them from the pin.
+     */
+    void addView(PotentiometerView &view);
+
+    /**
+     * Estimate velocity and acceleration from the filtered value on every read().
+     * 
+     * The estimator must stay in scope as long as the pot is used. Supply 
+     * nullptr to stop.
+     */
+    void setMotionEstimator(MotionEstimator *motion);
+
+    /**
+     * Where the pot will be in ms milliseconds at its current velocity, 
+     * at the configured resolution. Needs a MotionEstimator.
+     * 
+     * @param unsigned int ms How far to look ahead, ie the latency to make up.
+     */
+    int getPredictedValue(unsigned int ms);
+
+    /**
+     * Current configuration, ie after calibrateNoise().
+     */
+    inline int getResolution() { return _resolution; }
+    inline float getSmoothingFactor() { return _smoothingFactor; }
+    inline byte getReadCount() { return _readCount; }
+    inline unsigned int getReadDelay() { return _readDelay; }
+
+    /**
+     * Read the pin a number of times and measure the raw noise.
+     * The pot must not be touched.
+     * 
+     * @param unsigned int samples Number of reads, up to NoiseMeter::MAX_SAMPLES.
+     */
+    NoiseProfile measureNoise(unsigned int samples = 256);
+
+    /**
+     * Pick the cheapest configuration that will not report changes while the
+     * pot is at rest. The pot must not be touched. Call after begin().
+     * 
+     * Tries no smoothing first, then increasingly heavy smoothing, and keeps 
+     * the first setting whose noise fits within half a step of the resolution 
+     * (or 2 raw units with no resolution). The noise floor is then set to the 
+     * noise that remains, so noise at that level can never cause a change.
+     * 
+     * Uses a single read, and no read delay unless a Multiplexer is in use. 
+     * Extra reads (only the last is kept) and read delays do not lower the 
+     * noise of a pin on their own: they give the ADC time to settle after 
+     * reading a different pin, which reading this pin alone cannot measure.
+     * If neighbouring pins bleed into this one, use setReadCount() or 
+     * setReadDelay() again after calibrating.
+     * 
+     * @param unsigned int samples Number of reads per setting tried.
+     * @return NoiseProfile The raw noise measured before tuning.
+     */
+    NoiseProfile calibrateNoise(unsigned int samples = 256);
+
+    /**
+     * Seed begin() from a burst of reads instead of a single read.
+     * 
+     * The highest and lowest reads are dropped and the rest are averaged, and 
+     * changed() stays false until the filter has settled to within the noise 
+     * floor (or WARM_START_BAND) of the pin. This stops a burst of false 
+     * changes while the smoothing catches up after power on.
+     * 
+     * @param byte samples Number of reads, up to MAX_WARM_START. Default is 0 (disabled).
+     */
+    void setWarmStart(byte samples);
+
+    /**
+     * Whether changes are still being suppressed after a warm start.
+     */
+    inline boolean isSettling() { return _settling; }
+
+    static constexpr byte MAX_WARM_START = 32;
+    static constexpr byte WARM_START_BAND = 2;
+
+    /**
+     * Apply a response curve before resolution mapping and change detection.
+     * 
+     * The curve is a PROGMEM table of evenly spaced points over the raw range, 
+     * with output values in 0-MAX, evaluated by linear interpolation between 
+     * points. See SC_Curves.h for built-in curves, ie CURVE_EXPONENTIAL.
+     * 
+     * @param const uint16_t* table PROGMEM table, or nullptr for a linear response.
+     * @param byte points Number of points in the table (at least 2).
+     */
+    void setResponseCurve(const uint16_t *table, byte points = CURVE_POINTS);
+
+    /**
+     * Set the raw values the pot actually reaches at each end of its travel.
+     * 
+     * Values are stretched so these read as 0 and MAX (before resolution), 
+     * which makes sure the full output range can be reached.
+     */
+    void setEndStops(int min, int max);
+
+    /**
+     * Ignore changes smaller than this many raw units since the last change.
+     * 
+     * Default is 0.
+     */
+    void setNoiseFloor(byte noiseFloor);
+
+    /**
+     * End stops and noise floor.
+     */
+    inline int getMinRaw() { return _minRaw; }
+    inline int getMaxRaw() { return _maxRaw; }
+    inline byte getNoiseFloor() { return _noiseFloor; }
+
+    /**
+     * Save end stops and noise floor.
+     */
+    virtual void saveCalibration(CalibrationRecord &record);
+
+    /**
+     * Restore end stops and noise floor.
+     */
+    virtual void loadCalibration(const CalibrationRecord &record);
+
+    /**
+     * Record kind saved by potentiometers.
+     */
+    static constexpr byte CALIBRATION_KIND = 'P';
+
     /**
      * Get the current potentiometer value at the configured resolution.
      * 
@@ -112,9 +309,9 @@ class Potentiometer : public Control {
     inline void resetChanged() { _changed = false; }
 
     /**
-     * Time since last change in millis.
+     * Time of last change in millis (from Clock::now()).
      */
-    inline int lastChange() { return _lastChange; }
+    inline uint32_t lastChange() { return _lastChange; }
 
   protected:
     byte _pin;
@@ -122,8 +319,17 @@ class Potentiometer : public Control {
     float _smoothingFactor;
     byte _readCount; 
     unsigned int _readDelay;
-    int _time = 0, _lastChange = 0;
-    int _value, _lastValue;
+    uint32_t _time = 0, _lastChange = 0;
+    int _value = 0, _lastValue = 0;
+    int _minRaw = 0, _maxRaw = MAX;
+    byte _noiseFloor = 0;
+    byte _warmStart = 0;
+    byte _curvePoints = 0;
+    const uint16_t *_curve = nullptr;
+    PotentiometerView *_views = nullptr;
+    MotionEstimator *_motion = nullptr;
+    boolean _settling = false;
+    TimeConstantFilter *_filter = nullptr;
     
     /**
      * Calculate whether to set _changed based on resolution.
@@ -134,6 +340,31 @@ class Potentiometer : public Control {
      * Change value to configured resolution.
      */
     int _applyResolution(int raw);
+
+    /**
+     * Apply end stops and response curve, giving a value from 0 to MAX.
+     */
+    int _applyShape(int raw);
+
+    /**
+     * Remap a shaped value to a resolution.
+     */
+    static int _scale(int shaped, int resolution);
+
+    /**
+     * Update every view from the current value.
+     */
+    void _updateViews();
+
+    /**
+     * Start a view from the current value without reporting a change.
+     */
+    void _seedView(PotentiometerView &view);
+
+    /**
+     * Look up a value on the response curve.
+     */
+    int _applyCurve(int raw);
     
     /**
      * Read pin using various anti-jitter strategies, if requested.
@@ -144,5 +375,10 @@ class Potentiometer : public Control {
      * Smooth the value based on smoothing strategy and settings.
      */ 
     int _smoothValue(const int raw);
+
+    /**
+     * Seed begin() from a burst of reads.
+     */ 
+    int _readSeed();
   
 };
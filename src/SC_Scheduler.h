@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Control.h"
+
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#endif
+
+/**
+ * Adaptive, idle-aware polling for a set of controls.
+ *
+ * Instead of reading every control on every loop(), each control gets its own
+ * polling interval. A control that is moving is read on every poll(). Once it
+ * has been idle for longer than the idle time, its interval doubles on every
+ * read until it reaches the maximum interval. As soon as a change is seen,
+ * the control snaps back to full rate.
+ *
+ * The price is latency: a control that has decayed is only read every
+ * maxInterval milliseconds, so the first movement after a quiet spell is seen
+ * up to maxInterval late (half that on average). This is a time, not a count
+ * of polls, so with a fast loop it can be dozens or hundreds of polls. Lower
+ * maxInterval for controls that must respond to their very first movement.
+ * extras/host/scheduler_harness measures both sides for your numbers.
+ *
+ * When every control is idle, sleep() can be used to put the CPU to sleep
+ * until the next interrupt. On AVR, sleepUntilPinChange() powers down completely
+ * and wakes on a pin-change interrupt from one of the wake pins (buttons only,
+ * potentiometers and joysticks cannot generate a pin change).
+ *
+ * To use pin-change wake, define SC_ENABLE_PCINT_WAKE before including this
+ * file in exactly one sketch file. This defines empty PCINT interrupt handlers,
+ * which will clash with other libraries that use them (ie SoftwareSerial).
+ *
+ * Usage:
+ *
+ *   ControlScheduler<3> scheduler;
+ *   scheduler.add(pot1);
+ *   scheduler.add(pot2);
+ *   scheduler.add(button);
+ *   ...
+ *   void loop() {
+ *     scheduler.poll();
+ *     if (pot1.changed()) { ... }
+ *   }
+ *
+ * Note that changed() is only meaningful right after poll() has read the control,
+ * so a control that was skipped this poll will report no change.
+ */
+template<byte N>
+class ControlScheduler {
+
+  public:
+
+    /**
+     * @param unsigned int idleTime (Optional) Milliseconds without change before a control starts slowing down. Default is 1000.
+     * @param unsigned int maxInterval (Optional) Slowest polling interval in milliseconds, and so the longest a quiet control can take to see its first change. Default is 64.
+     */
+    ControlScheduler(unsigned int idleTime = 1000, unsigned int maxInterval = 64) :
+      _idleTime(idleTime), _maxInterval(maxInterval) {}
+
+    /**
+     * Add a control to the scheduler.
+     *
+     * @return boolean False if the scheduler is full.
+     */
+    boolean add(Control &control) {
+      if (_count >= N) {
+        return false;
+      }
+      Slot &slot = _slots[_count++];
+      slot.control = &control;
+      slot.interval = 0;
+      slot.lastRead = Clock::now();
+      slot.lastActive = slot.lastRead;
+      return true;
+    }
+
+    /**
+     * Read every control that is due.
+     *
+     * This should be called once in the Arduino loop(), instead of calling
+     * read() on each control. Captures the Clock time for this scan, and
+     * goes back to live time at the end of it, so controls read outside the
+     * scheduler still see time moving.
+     *
+     * @return byte The number of controls that changed.
+     */
+    byte poll() {
+
+      byte changes = 0;
+      ClockScan scan;
+      uint32_t ms = Clock::now();
+
+      for (byte i=0; i<_count; i++) {
+
+        Slot &slot = _slots[i];
+        if (ms - slot.lastRead < slot.interval) {
+          continue;
+        }
+
+        slot.lastRead = ms;
+        slot.control->read();
+
+        if (slot.control->changed()) {
+
+          //snap back to full rate
+          slot.lastActive = ms;
+          slot.interval = 0;
+          changes++;
+
+        } else if (ms - slot.lastActive >= _idleTime && slot.interval < _maxInterval) {
+
+          //decay
+          slot.interval = slot.interval ? slot.interval << 1 : 1;
+          if (slot.interval > _maxInterval) {
+            slot.interval = _maxInterval;
+          }
+
+        }
+
+      }
+
+      return changes;
+
+    }
+
+    /**
+     * Whether every control has decayed to the slowest polling rate.
+     */
+    boolean isIdle() {
+      for (byte i=0; i<_count; i++) {
+        if (_slots[i].interval < _maxInterval) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Put every control back to full rate.
+     */
+    void wake() {
+      uint32_t ms = Clock::now();
+      for (byte i=0; i<_count; i++) {
+        _slots[i].interval = 0;
+        _slots[i].lastActive = ms;
+      }
+    }
+
+    /**
+     * Sleep until the next interrupt, if every control is idle.
+     *
+     * Uses idle sleep, so millis() keeps running and the timer tick wakes
+     * the CPU again within a millisecond. Does nothing on non-AVR boards.
+     *
+     * @return boolean Whether we slept.
+     */
+    boolean sleep() {
+      if (!isIdle()) {
+        return false;
+      }
+#if defined(__AVR__)
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      sleep_mode();
+      return true;
+#else
+      return false;
+#endif
+    }
+
+#if defined(__AVR__) && defined(digitalPinToPCICR)
+
+    /**
+     * Allow a pin to wake the CPU from sleepUntilPinChange().
+     *
+     * @return boolean False if the pin has no pin-change interrupt.
+     */
+    boolean addWakePin(byte pin) {
+      volatile uint8_t *pcicr = digitalPinToPCICR(pin);
+      if (!pcicr) {
+        return false;
+      }
+      *digitalPinToPCMSK(pin) |= bit(digitalPinToPCMSKbit(pin));
+      _wakeMask |= bit(digitalPinToPCICRbit(pin));
+      return true;
+    }
+
+    /**
+     * Power down until one of the wake pins changes, if every control is idle.
+     *
+     * millis() stops while powered down. All controls are put back to full rate
+     * on wake so the first event is seen on the next poll(), which also 
+     * captures a fresh Clock time.
+     *
+     * @return boolean Whether we slept.
+     */
+    boolean sleepUntilPinChange() {
+      if (!_wakeMask || !isIdle()) {
+        return false;
+      }
+      set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+      cli();
+      PCIFR |= _wakeMask;
+      PCICR |= _wakeMask;
+      sleep_enable();
+      sei();
+      sleep_cpu();
+      sleep_disable();
+      PCICR &= ~_wakeMask;
+      wake();
+      return true;
+    }
+
+#endif
+
+    /**
+     * Current polling interval of a control in milliseconds, 0 meaning every poll.
+     */
+    inline unsigned int getInterval(byte index) { return _slots[index].interval; }
+
+  protected:
+
+    struct Slot {
+      Control *control;
+      uint32_t lastRead;
+      uint32_t lastActive;
+      unsigned int interval;
+    };
+
+    Slot _slots[N];
+    byte _count = 0;
+    unsigned int _idleTime;
+    unsigned int _maxInterval;
+#if defined(__AVR__) && defined(digitalPinToPCICR)
+    byte _wakeMask = 0;
+#endif
+
+};
+
+#if defined(SC_ENABLE_PCINT_WAKE) && defined(__AVR__)
+#if defined(PCINT0_vect)
+EMPTY_INTERRUPT(PCINT0_vect);
+#endif
+#if defined(PCINT1_vect)
+EMPTY_INTERRUPT(PCINT1_vect);
+#endif
+#if defined(PCINT2_vect)
+EMPTY_INTERRUPT(PCINT2_vect);
+#endif
+#if defined(PCINT3_vect)
+EMPTY_INTERRUPT(PCINT3_vect);
+#endif
+#endif
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Control.h"
+#include "SC_Potentiometer.h"
+
+/**
+ * Integer Exponential Moving Average with alpha = 1 / 2^Shift.
+ *
+ * Keeps the average scaled up by 2^Shift so small movements are not lost
+ * to rounding. Ema<0> is no smoothing, Ema<1> is close to the Potentiometer
+ * default of 0.6, and each step up halves the alpha, up to Ema<6>. The state
+ * settles at up to 1023 << Shift (plus rounding), which only fits in 16 bits
+ * up to a shift of 6. Intermediate sums may wrap, but unsigned arithmetic
+ * wraps back by the time the old state is taken off again.
+ */
+template<byte Shift>
+struct Ema {
+
+  static_assert(Shift <= 6, "Ema shift must be 0-6, the state is a 10 bit value scaled up by 2^Shift in 16 bits");
+
+  /**
+   * Filter state for a starting value.
+   */
+  static inline uint16_t seed(int raw) {
+    return (uint16_t)raw << Shift;
+  }
+
+  /**
+   * Add a new sample to the filter state.
+   */
+  static inline uint16_t update(uint16_t state, int raw) {
+    return state + raw - (state >> Shift);
+  }
+
+  /**
+   * Current filtered value.
+   */
+  static inline int value(uint16_t state) {
+    return state >> Shift;
+  }
+
+};
+
+/**
+ * No smoothing.
+ */
+typedef Ema<0> NoSmoothing;
+
+/**
+ * Potentiometer with its configuration fixed at compile time.
+ *
+ * Behaves like Potentiometer, but the pin, resolution, smoothing, read count
+ * and read delay are template parameters, so they are folded into the code
+ * instead of taking RAM in every instance. Smoothing uses integer maths only.
+ *
+ * Usage:
+ *
+ *   StaticPotentiometer<A0, 128, Ema<2>> pot;
+ *
+ * @param Pin The pin the pot is connected to (the signal pin if using a Multiplexer).
+ * @param Resolution (Optional) Supply a number smaller than MAX(1023) to have output scaled. Default 0 (no scaling).
+ * @param Filter (Optional) Smoothing filter. Default Ema<1>.
+ * @param ReadCount (Optional) How many times to read the pin. Default is 1.
+ * @param ReadDelay (Optional) Microseconds to delay before each read. Default is 1.
+ */
+template<byte Pin, int Resolution = 0, class Filter = Ema<1>, byte ReadCount = 1, unsigned int ReadDelay = 1>
+class StaticPotentiometer : public Control {
+
+  public:
+
+    /**
+     * Per-instance RAM allowed on top of the Control base: filter state, last value 
+     * and change time take 8 bytes, leaving 2 spare on AVR (4 on hosts, for padding).
+     */
+#if defined(__AVR__)
+    static constexpr size_t RAM_BUDGET = sizeof(Control) + 10;
+#else
+    static constexpr size_t RAM_BUDGET = sizeof(Control) + 12;
+#endif
+
+    StaticPotentiometer(Multiplexer *mux=nullptr, byte muxChannel=0) {
+      setMultiplexer(mux, muxChannel);
+    }
+
+    /**
+     * Initialise.
+     *
+     * Does an initial read as a starting point, but
+     * will not update the changed status.
+     */
+    virtual void begin() {
+      static_assert(sizeof(StaticPotentiometer) <= RAM_BUDGET, "StaticPotentiometer exceeds its RAM budget");
+      _state = Filter::seed(analogRead(Pin));
+      _lastValue = getRawValue();
+      _lastChange = Clock::now();
+    }
+
+    /**
+     * Update current value of the control and test whether we have changed.
+     *
+     * This should be called once in the Arduino loop().
+     *
+     * @return boolean Whether the value has changed since last read.
+     */
+    virtual boolean read() {
+
+      _statsBeginRead();
+
+      int raw = 0;
+      for (byte i=0; i<ReadCount; i++) {
+        if (ReadDelay > 0) {
+          delayMicroseconds(ReadDelay);
+        }
+        raw = analogRead(Pin);
+      }
+
+      _state = Filter::update(_state, raw);
+
+      int value = getRawValue();
+      _changed = _applyResolution(value) != _applyResolution(_lastValue);
+      if (_changed) {
+        _lastChange = Clock::now();
+      }
+      _lastValue = value;
+
+      _statsNoise(value);
+      _statsEndRead();
+
+      return _changed;
+
+    }
+
+    /**
+     * Get the current potentiometer value at the configured resolution.
+     */
+    inline int getValue() { return _applyResolution(getRawValue()); }
+
+    /**
+     * Get current value, ignoring resolution.
+     */
+    inline int getRawValue() { return Filter::value(_state); }
+
+    /**
+     * Whether the value has changed since the last read.
+     */
+    inline boolean changed() { return _changed; }
+
+    /**
+     * Sometimes required to convince the pot it hasn't changed. Bit of a hack.
+     */
+    inline void resetChanged() { _changed = false; }
+
+    /**
+     * Time of last change in millis.
+     */
+    inline uint32_t lastChange() { return _lastChange; }
+
+  protected:
+    uint16_t _state = 0;
+    int _lastValue = 0;
+    uint32_t _lastChange = 0;
+
+    /**
+     * Change value to configured resolution.
+     */
+    static inline int _applyResolution(int raw) {
+      return Resolution > 0 ? map(raw, 0, Potentiometer::MAX, 0, Resolution) : raw;
+    }
+
+};
@@ -0,0 +1,110 @@
+/**
+ * Instrumentation counters for a single control.
+ */
+
+#include "SC_Stats.h"
+
+#if SC_ENABLE_STATS
+
+/**
+ * Clear all counters.
+ */
+void ControlStats::reset() {
+    reads = 0;
+    changes = 0;
+    muxSwitches = 0;
+    since = Clock::now();
+    totalMicros = 0;
+    minMicros = 0xFFFF;
+    maxMicros = 0;
+    noiseBand = 0;
+    idleMin = 0x7FFF;
+    idleMax = -0x7FFF;
+}
+
+/**
+ * Mark the end of a read.
+ */
+void ControlStats::endRead(boolean changed) {
+
+    uint32_t elapsed = micros() - startMicros;
+    uint16_t us = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+
+    reads++;
+    totalMicros += us;
+    if (us < minMicros) minMicros = us;
+    if (us > maxMicros) maxMicros = us;
+    if (changed) changes++;
+
+}
+
+/**
+ * Track the value band while the control is idle.
+ *
+ * The band is restarted whenever the control changes, so only
+ * movement that did not produce a change counts as noise.
+ */
+void ControlStats::recordNoise(int value, boolean changed) {
+
+    if (changed) {
+        idleMin = value;
+        idleMax = value;
+        return;
+    }
+
+    if (value < idleMin) idleMin = value;
+    if (value > idleMax) idleMax = value;
+    if (idleMax > idleMin && (uint16_t)(idleMax - idleMin) > noiseBand) {
+        noiseBand = idleMax - idleMin;
+    }
+
+}
+
+/**
+ * Average read() duration in microseconds.
+ */
+uint16_t ControlStats::avgMicros() const {
+    return reads ? totalMicros / reads : 0;
+}
+
+/**
+ * Changes per second since the last reset, multiplied by 100.
+ */
+uint32_t ControlStats::changesPerSecond100() const {
+    uint32_t ms = Clock::elapsed(since);
+    if (ms == 0) {
+        return 0;
+    }
+    //exact while changes * 100000 fits in 32 bits, then in whole seconds
+    if (changes <= 0xFFFFFFFFUL / 100000UL) {
+        return (changes * 100000UL) / ms;
+    }
+    uint32_t seconds = ms / 1000;
+    return (changes * 100UL) / (seconds ? seconds : 1);
+}
+
+/**
+ * Dump as a single line.
+ */
+void ControlStats::printTo(Print &out) const {
+    uint32_t cps = changesPerSecond100();
+    out.print("reads=");
+    out.print(reads);
+    out.print(" chg/s=");
+    out.print(cps / 100);
+    out.print('.');
+    if (cps % 100 < 10) out.print('0');
+    out.print(cps % 100);
+    out.print(" mux=");
+    out.print(muxSwitches);
+    out.print(" us=");
+    out.print(reads ? minMicros : 0);
+    out.print('/');
+    out.print(avgMicros());
+    out.print('/');
+    out.print(maxMicros);
+    out.print(" noise=");
+    out.println(noiseBand);
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Config.h"
+#include "SC_Clock.h"
+
+#if SC_ENABLE_STATS
+
+/**
+ * Instrumentation counters for a single control.
+ *
+ * Only compiled in when SC_ENABLE_STATS is set.
+ */
+struct ControlStats {
+
+  uint32_t reads = 0;           // number of calls to read()
+  uint32_t changes = 0;         // number of reads that reported a change
+  uint32_t muxSwitches = 0;     // number of mux channel selections
+  uint32_t since = 0;           // Clock::now() when the stats were last reset
+  uint32_t totalMicros = 0;     // total time spent in read()
+  uint16_t minMicros = 0xFFFF;  // fastest read()
+  uint16_t maxMicros = 0;       // slowest read()
+  uint16_t noiseBand = 0;       // widest value band seen while idle
+  int idleMin = 0x7FFF;         // value band since the last change
+  int idleMax = -0x7FFF;
+  uint32_t startMicros = 0;     // start of the current read()
+
+  /**
+   * Clear all counters.
+   */
+  void reset();
+
+  /**
+   * Mark the start of a read.
+   */
+  inline void beginRead() { startMicros = micros(); }
+
+  /**
+   * Mark the end of a read.
+   */
+  void endRead(boolean changed);
+
+  /**
+   * Track the value band while the control is idle.
+   */
+  void recordNoise(int value, boolean changed);
+
+  /**
+   * Average read() duration in microseconds.
+   */
+  uint16_t avgMicros() const;
+
+  /**
+   * Changes per second since the last reset, multiplied by 100.
+   */
+  uint32_t changesPerSecond100() const;
+
+  /**
+   * Dump as a single line, ie "reads=.. chg/s=.. mux=.. us=min/avg/max noise=..".
+   */
+  void printTo(Print &out) const;
+
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * Exponential moving average over a time constant.
+ */
+
+#include "SC_TimeFilter.h"
+
+/**
+ * Filter alpha, 1 - e^-x, in 1/32768ths for x = 0-2 in steps of 1/16.
+ */
+static const uint16_t SMOOTHING_ALPHA[33] PROGMEM = {
+    0, 1985, 3850, 5602, 7248, 8794, 10247, 11611, 12893, 14097, 15229, 
+    16291, 17289, 18227, 19108, 19936, 20713, 21444, 22130, 22774, 23380, 
+    23949, 24483, 24985, 25456, 25899, 26316, 26707, 27074, 27419, 27743, 
+    28047, 28333
+};
+
+/**
+ * Start again from a value.
+ */
+void TimeConstantFilter::reset(int value, uint32_t micros) {
+    _state = (uint16_t)value << 5;
+    _time = micros;
+    _pendingSum = 0;
+    _pendingCount = 0;
+}
+
+/**
+ * Add a new raw value. The state is kept in 1/32 units
+ * so slow movement is not lost to rounding.
+ */
+int TimeConstantFilter::update(int raw, uint32_t micros) {
+
+    //average reads that are too close together to use on their own
+    if (_pendingCount >= 64) {
+        _pendingSum >>= 1;
+        _pendingCount >>= 1;
+    }
+    _pendingSum += raw;
+    _pendingCount++;
+
+    uint32_t step = max(((uint32_t)_timeConstant * 1000) >> 6, (uint32_t)1);
+    uint32_t elapsed = micros - _time;
+    if (elapsed < step) {
+        return (_state + 16) >> 5;
+    }
+
+    //keep the part of a step not used yet for next time
+    uint32_t steps = elapsed / step;
+    _time += steps * step;
+    if (steps > 512) {
+        steps = 512;
+    }
+
+    long target = ((long)_pendingSum << 5) / _pendingCount;
+    _pendingSum = 0;
+    _pendingCount = 0;
+
+    //the table covers two time constants, apply longer gaps in pieces
+    while (steps > 0) {
+
+        byte n = min(steps, (uint32_t)128);
+        steps -= n;
+
+        byte i = n >> 2;
+        uint16_t alpha = pgm_read_word(&SMOOTHING_ALPHA[i]);
+        if (i < 32) {
+            uint16_t next = pgm_read_word(&SMOOTHING_ALPHA[i + 1]);
+            alpha += ((next - alpha) * (n & 3)) >> 2;
+        }
+
+        long delta = target - _state;
+        long change = (labs(delta) * alpha + 16384) >> 15;
+        _state += delta < 0 ? -change : change;
+
+    }
+
+    return (_state + 16) >> 5;
+
+}
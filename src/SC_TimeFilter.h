@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Exponential moving average over a time constant, rather than a fixed
+ * factor per read, so a control responds in the same number of milliseconds
+ * however often it is read. After a step, the output is about 63% of the 
+ * way there after one time constant, and 95% after three.
+ * 
+ * Elapsed time is counted in steps of 1/64 of the time constant. Reads less 
+ * than a step apart are averaged together, then applied as one update once 
+ * a step has passed. Alpha comes from a PROGMEM table of 1 - e^-x, so there 
+ * are no floats or exp() at runtime.
+ * 
+ * Attach to a Potentiometer with setSmoothingFilter(). Pots that don't use
+ * one pay only for the pointer.
+ */
+class TimeConstantFilter {
+
+  public:
+
+    /**
+     * @param unsigned int ms Time constant in milliseconds.
+     */
+    TimeConstantFilter(unsigned int ms) : _timeConstant(ms) {}
+
+    /**
+     * Change the time constant.
+     */
+    inline void setTimeConstant(unsigned int ms) { _timeConstant = ms; }
+    inline unsigned int getTimeConstant() { return _timeConstant; }
+
+    /**
+     * Start again from a value.
+     * 
+     * @param int value The current value.
+     * @param uint32_t micros Time of the value, ie from Clock::nowMicros().
+     */
+    void reset(int value, uint32_t micros);
+
+    /**
+     * Add a new raw value.
+     * 
+     * @param int raw The value read from the pin.
+     * @param uint32_t micros Time of the read, ie from Clock::nowMicros().
+     * @return int The filtered value.
+     */
+    int update(int raw, uint32_t micros);
+
+  protected:
+    unsigned int _timeConstant;
+    uint32_t _time = 0;
+    uint16_t _state = 0;
+    uint16_t _pendingSum = 0;
+    byte _pendingCount = 0;
+
+};
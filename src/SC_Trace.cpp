@@ -0,0 +1,239 @@
+/**
+ * Raw sample tracing, for tuning filters offline.
+ */
+
+#include "SC_Trace.h"
+
+#if SC_ENABLE_TRACE
+
+constexpr byte TraceRecorder::MAX_SAMPLE;
+
+TraceRecorder *Trace::recorder = nullptr;
+TracePlayer *Trace::player = nullptr;
+
+/**
+ * Find the last value for a pin and channel, adding it if new.
+ *
+ * When full, reuses the oldest entry.
+ */
+int &TraceKeyTable::lookup(byte pin, byte channel) {
+
+    for (byte i=0; i<_count; i++) {
+        if (_pins[i] == pin && _channels[i] == channel) {
+            return _values[i];
+        }
+    }
+
+    byte i;
+    if (_count < TRACE_KEYS) {
+        i = _count++;
+    } else {
+        i = _next;
+        _next = (_next + 1) % TRACE_KEYS;
+    }
+
+    _pins[i] = pin;
+    _channels[i] = channel;
+    _values[i] = 0;
+    return _values[i];
+
+}
+
+/**
+ * Write the header and start recording every control read.
+ */
+void TraceRecorder::start() {
+    _keys.clear();
+    _out.write('S');
+    _out.write('C');
+    _out.write('T');
+    _out.write(TRACE_VERSION);
+    _lastMicros = Clock::nowMicros();
+    _dropped = 0;
+    Trace::recorder = this;
+}
+
+/**
+ * Stop recording.
+ */
+void TraceRecorder::stop() {
+    if (Trace::recorder == this) {
+        Trace::recorder = nullptr;
+    }
+}
+
+/**
+ * Write a single sample, if there is room for it.
+ */
+void TraceRecorder::record(byte pin, byte channel, int value) {
+
+    //never block inside read()
+    if (_out.availableForWrite() < MAX_SAMPLE) {
+        _dropped++;
+        return;
+    }
+
+    uint32_t us = Clock::nowMicros();
+    int &last = _keys.lookup(pin, channel);
+    int dv = value - last;
+    last = value;
+
+    if (channel == TRACE_NO_CHANNEL) {
+        _out.write(pin & 0x7F);
+    } else {
+        _out.write(0x80 | pin);
+        _out.write(channel);
+    }
+
+    _writeVarint(us - _lastMicros);
+    _writeVarint(dv < 0 ? ((uint32_t)(-(long)dv) << 1) - 1 : (uint32_t)dv << 1);
+    _lastMicros = us;
+
+}
+
+/**
+ * Write a value 7 bits at a time, least significant first.
+ */
+void TraceRecorder::_writeVarint(uint32_t value) {
+    while (value > 0x7F) {
+        _out.write((byte)(value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    _out.write((byte)value);
+}
+
+/**
+ * Start again at the header.
+ */
+void TraceDecoder::reset() {
+    _keys.clear();
+    _sample = TraceSample();
+    _state = HEADER;
+    _headerPos = 0;
+    _varint = 0;
+    _shift = 0;
+}
+
+/**
+ * Decode the next byte.
+ */
+boolean TraceDecoder::push(byte b) {
+
+    switch (_state) {
+
+        case HEADER: {
+            static const char header[] = { 'S', 'C', 'T', TRACE_VERSION };
+            if (b != (byte)header[_headerPos]) {
+                _state = FAILED;
+            } else if (++_headerPos == sizeof(header)) {
+                _state = KEY;
+            }
+            return false;
+        }
+
+        case KEY:
+            _sample.pin = b & 0x7F;
+            _sample.channel = TRACE_NO_CHANNEL;
+            _state = (b & 0x80) ? CHANNEL : TIME;
+            return false;
+
+        case CHANNEL:
+            _sample.channel = b;
+            _state = TIME;
+            return false;
+
+        case TIME:
+            if (_pushVarint(b)) {
+                _sample.time += _varint;
+                _state = VALUE;
+            }
+            return false;
+
+        case VALUE:
+            if (_pushVarint(b)) {
+                long dv = (_varint & 1) ? -(long)((_varint + 1) >> 1) : (long)(_varint >> 1);
+                int &last = _keys.lookup(_sample.pin, _sample.channel);
+                last += dv;
+                _sample.value = last;
+                _state = KEY;
+                return true;
+            }
+            return false;
+
+        default:
+            return false;
+
+    }
+
+}
+
+/**
+ * Add a byte to the current varint.
+ */
+boolean TraceDecoder::_pushVarint(byte b) {
+    if (_shift == 0) {
+        _varint = 0;
+    }
+    _varint |= (uint32_t)(b & 0x7F) << _shift;
+    if (b & 0x80) {
+        //a 32 bit value never needs more than 5 bytes
+        _shift += 7;
+        if (_shift > 28) {
+            _state = FAILED;
+        }
+        return false;
+    }
+    _shift = 0;
+    return true;
+}
+
+/**
+ * Start feeding controls from this player, and drive Clock from it.
+ */
+void TracePlayer::start() {
+    _keys.clear();
+    _time = 0;
+    _millis = 0;
+    _micros = 0;
+    Trace::player = this;
+    Clock::release();
+    Clock::setSource(_clockMillis, _clockMicros);
+}
+
+/**
+ * Go back to reading the hardware and the real clock.
+ */
+void TracePlayer::stop() {
+    if (Trace::player == this) {
+        Trace::player = nullptr;
+        Clock::release();
+        Clock::setSource(nullptr);
+    }
+}
+
+/**
+ * Make a sample the current value of its pin, and its time the current time.
+ * Milliseconds are counted from the microsecond deltas so they don't jump
+ * when the microseconds wrap around.
+ */
+void TracePlayer::apply(const TraceSample &sample) {
+    _keys.lookup(sample.pin, sample.channel) = sample.value;
+    uint32_t dt = sample.time - _time;
+    _time = sample.time;
+    _millis += dt / 1000;
+    _micros += dt % 1000;
+    if (_micros >= 1000) {
+        _micros -= 1000;
+        _millis++;
+    }
+}
+
+uint32_t TracePlayer::_clockMillis() {
+    return Trace::player ? Trace::player->_millis : 0;
+}
+
+uint32_t TracePlayer::_clockMicros() {
+    return Trace::player ? Trace::player->_time : 0;
+}
+
+#endif
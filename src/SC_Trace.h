@@ -0,0 +1,244 @@
+#pragma once
+
+#include "Arduino.h"
+#include "SC_Config.h"
+#include "SC_Clock.h"
+
+#if SC_ENABLE_TRACE
+
+/**
+ * Raw sample tracing, for tuning filters offline.
+ *
+ * While a TraceRecorder is started, every analogRead/digitalRead made by a
+ * control is written to its output with a timestamp. While a TracePlayer is
+ * started, controls read the player's values instead of the hardware, and
+ * Clock runs on the recorded timestamps, so a recorded trace can be replayed
+ * through the real control code (debounce, hold times and time-constant 
+ * smoothing included). See extras/host for a replay tool for the PC.
+ *
+ * Stream format:
+ *
+ *   Header:  'S' 'C' 'T' VERSION
+ *   Sample:  [key] ([channel]) [dt] [dv]
+ *
+ *   key      pin number in bits 0-6. Bit 7 is set if a mux channel byte follows.
+ *   dt       microseconds since the previous sample, as a varint.
+ *   dv       change in value since the previous sample of the same pin and
+ *            channel, zigzag encoded as a varint. The first sample of a pin
+ *            is relative to 0.
+ *
+ * Varints are 7 bits per byte, least significant first, with the top bit set
+ * on every byte except the last. A resting pot costs 4 bytes per sample at 
+ * normal loop rates (a 2 byte dt for 128us-16ms between samples), or 3 bytes
+ * when samples are less than 128us apart.
+ *
+ * Only TRACE_KEYS pins are tracked for deltas at once. When the table is full,
+ * the oldest entry is reused; the decoder does the same so they stay in step.
+ */
+
+/**
+ * One decoded sample.
+ */
+struct TraceSample {
+  uint32_t time;    // microseconds since the start of the trace
+  byte pin;
+  byte channel;     // mux channel, or TRACE_NO_CHANNEL
+  int value;
+};
+
+static constexpr byte TRACE_VERSION = 1;
+static constexpr byte TRACE_KEYS = 16;
+static constexpr byte TRACE_NO_CHANNEL = 0xFF;
+
+/**
+ * Last value of each pin/channel, for delta encoding.
+ */
+class TraceKeyTable {
+
+  public:
+
+    /**
+     * Find the last value for a pin and channel, adding it if new.
+     */
+    int &lookup(byte pin, byte channel);
+
+    /**
+     * Forget every pin.
+     */
+    inline void clear() { _count = 0; _next = 0; }
+
+  protected:
+    byte _pins[TRACE_KEYS];
+    byte _channels[TRACE_KEYS];
+    int _values[TRACE_KEYS];
+    byte _count = 0;
+    byte _next = 0;
+
+};
+
+/**
+ * Writes raw samples from controls to a Print, ie Serial.
+ *
+ * Samples are only written when the output has room for a whole sample, so
+ * recording never blocks inside read() and distorts the timing it records.
+ * Samples that don't fit are dropped (and counted); the next sample is then
+ * encoded against the last one written, so the stream stays consistent.
+ *
+ * The output must report availableForWrite() (HardwareSerial does).
+ */
+class TraceRecorder {
+
+  public:
+
+    /**
+     * Longest encoded sample: key, channel, 5 byte dt and 3 byte dv.
+     */
+    static constexpr byte MAX_SAMPLE = 10;
+
+    TraceRecorder(Print &out) : _out(out) {}
+
+    /**
+     * Write the header and start recording every control read.
+     */
+    void start();
+
+    /**
+     * Stop recording.
+     */
+    void stop();
+
+    /**
+     * Write a single sample, if there is room for it.
+     */
+    void record(byte pin, byte channel, int value);
+
+    /**
+     * Samples dropped because the output was full, since start().
+     */
+    inline uint32_t dropped() { return _dropped; }
+
+  protected:
+    Print &_out;
+    TraceKeyTable _keys;
+    uint32_t _lastMicros = 0;
+    uint32_t _dropped = 0;
+
+    void _writeVarint(uint32_t value);
+
+};
+
+/**
+ * Decodes a recorded trace, one byte at a time.
+ */
+class TraceDecoder {
+
+  public:
+
+    /**
+     * Decode the next byte.
+     *
+     * @return boolean True when a sample has been completed, see sample().
+     */
+    boolean push(byte b);
+
+    /**
+     * The last completed sample.
+     */
+    inline const TraceSample &sample() { return _sample; }
+
+    /**
+     * Whether the header was missing, the version is not supported,
+     * or the stream is corrupt.
+     */
+    inline boolean failed() { return _state == FAILED; }
+
+    /**
+     * Start again at the header.
+     */
+    void reset();
+
+  protected:
+
+    enum State : byte { HEADER, KEY, CHANNEL, TIME, VALUE, FAILED };
+
+    TraceKeyTable _keys;
+    TraceSample _sample = TraceSample();
+    uint32_t _varint = 0;
+    byte _shift = 0;
+    byte _state = HEADER;
+    byte _headerPos = 0;
+
+    /**
+     * Add a byte to the current varint.
+     *
+     * @return boolean True when the varint is complete.
+     */
+    boolean _pushVarint(byte b);
+
+};
+
+/**
+ * Feeds recorded values to controls instead of the hardware.
+ *
+ * While started, the player is also the Clock source: Clock::now() and
+ * Clock::nowMicros() return the time of the last applied sample, so controls
+ * see the recorded timing rather than the time it takes to replay.
+ */
+class TracePlayer {
+
+  public:
+
+    /**
+     * Start feeding controls from this player, and drive Clock from it.
+     */
+    void start();
+
+    /**
+     * Go back to reading the hardware and the real clock.
+     */
+    void stop();
+
+    /**
+     * Make a sample the current value of its pin, and its time the current time.
+     */
+    void apply(const TraceSample &sample);
+
+    /**
+     * Current value of a pin.
+     */
+    inline int read(byte pin, byte channel) { return _keys.lookup(pin, channel); }
+
+    /**
+     * Time of the last applied sample, in microseconds since the start of the trace.
+     */
+    inline uint32_t time() { return _time; }
+
+    /**
+     * Time of the last applied sample, in milliseconds since the start of the trace.
+     * Unlike time() / 1000, this keeps counting when the microseconds wrap around.
+     */
+    inline uint32_t millis() { return _millis; }
+
+  protected:
+    TraceKeyTable _keys;
+    uint32_t _time = 0;
+    uint32_t _millis = 0;
+    uint16_t _micros = 0;
+
+    /**
+     * Clock sources while a player is started.
+     */
+    static uint32_t _clockMillis();
+    static uint32_t _clockMicros();
+
+};
+
+/**
+ * Currently active recorder and player, used by Control.
+ */
+struct Trace {
+  static TraceRecorder *recorder;
+  static TracePlayer *player;
+};
+
+#endif
@@ -2,4 +2,11 @@
 
 #include "SC_Button.h"
 #include "SC_Potentiometer.h"
-#include "SC_Multiplexer.h"
\ No newline at end of file
+#include "SC_Multiplexer.h"
+#include "SC_Scheduler.h"
+#include "SC_Output.h"
+#include "SC_StaticPotentiometer.h"
+#include "SC_Calibration.h"
+#include "SC_Clock.h"
+#include "SC_Gesture.h"
+#include "SC_AnalogAxes.h"
\ No newline at end of file